@@ -0,0 +1,160 @@
+#include "DecomposedSolver.hpp"
+
+#include <algorithm>
+#include <iostream>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+DecomposedSolver::DecomposedSolver(Problem* p, const LPSolverConfig& cfg) : problem(p), config(cfg) {
+	uint32_t n = p->nQP;
+	bestSol = VectorXd(n);
+	bestSol.setOnes();
+	lowerBound = p->score(bestSol);
+	upperBound = p->constantTerm;
+
+	std::vector<std::pair<uint32_t,uint32_t>> edges;
+	for(uint32_t j=1;j<n;j++){
+		for(SparseMatrix<double>::InnerIterator it(p->coeffs, j);it;++it){
+			upperBound += fabs(it.value());
+			if(it.row() > 0 && it.value() != 0) edges.push_back({(uint32_t)it.row(), j});
+		}
+	}
+	Graph g = Graph::fromEdges(n, edges);
+
+	//Components by BFS over variables 1..n-1
+	std::vector<bool> seen(n, false);
+	for(uint32_t s=1;s<n;s++){
+		if(seen[s]) continue;
+		std::vector<uint32_t> comp(1, s);
+		seen[s] = true;
+		for(uint32_t head=0;head<comp.size();head++){
+			uint32_t u = comp[head];
+			for(size_t a=g.offsets[u];a<g.offsets[u+1];a++){
+				uint32_t v = g.adj[a];
+				if(!seen[v]){
+					seen[v] = true;
+					comp.push_back(v);
+				}
+			}
+		}
+		std::sort(comp.begin(), comp.end());
+		components.push_back(comp);
+	}
+	std::stable_sort(components.begin(), components.end(), [](const std::vector<uint32_t>& a, const std::vector<uint32_t>& b){
+		return a.size() > b.size();
+	});
+}
+
+Problem* DecomposedSolver::subproblem(const std::vector<uint32_t>& vars) const {
+	uint32_t m = vars.size();
+	Problem* sub = new Problem(m+1);
+	//Every nonzero term of a variable in vars is with x_0 or another
+	//variable in vars, which is sorted
+	std::vector<Eigen::Triplet<double>> terms;
+	for(uint32_t b=0;b<m;b++){
+		for(SparseMatrix<double>::InnerIterator it(problem->coeffs, vars[b]);it;++it){
+			if(it.row() == 0){
+				terms.push_back({0, (int)b+1, it.value()});
+			} else if(it.value() != 0){
+				uint32_t a = std::lower_bound(vars.begin(), vars.end(), (uint32_t)it.row()) - vars.begin();
+				terms.push_back({(int)a+1, (int)b+1, it.value()});
+			}
+		}
+	}
+	sub->coeffs.setFromTriplets(terms.begin(), terms.end());
+	return sub;
+}
+
+void DecomposedSolver::solve(){
+	uint32_t n = problem->nQP;
+	uint32_t k = components.size();
+
+	//Seeds are drawn up front, so results don't depend on thread timing
+	Rng seeds(config.seed);
+	std::vector<uint64_t> componentSeed(k);
+	for(uint32_t c=0;c<k;c++) componentSeed[c] = seeds.split()();
+
+	std::vector<double> lbs(k), ubs(k);
+	std::vector<VectorXd> sols(k);
+	std::vector<SolverMetrics> componentMetrics(k);
+
+	if(config.verbose)
+		printf("%u components, largest has %u variables\n", k, k ? (uint32_t)components[0].size() : 0);
+
+	int threads = 1;
+#ifdef _OPENMP
+	if(config.parallelComponents)
+		threads = config.threads ? config.threads : omp_get_max_threads();
+#endif
+	bool parallel = threads > 1;
+	//Largest first, so the big LPs start early and the small ones fill in
+	#pragma omp parallel for schedule(dynamic, 1) num_threads(threads)
+	for(uint32_t c=0;c<k;c++){
+		const std::vector<uint32_t>& vars = components[c];
+		if(vars.size() == 1){
+			//x_j * l_j alone: take the sign of l_j
+			double l = problem->coeffs.coeff(0, vars[0]);
+			sols[c] = VectorXd(2);
+			sols[c] << 1, (l >= 0 ? 1 : -1);
+			lbs[c] = ubs[c] = fabs(l);
+			continue;
+		}
+
+		bool whole = vars.size() == n-1;
+		Problem* sub = whole ? problem : subproblem(vars);
+		LPSolverConfig subConfig = config;
+		subConfig.seed = componentSeed[c];
+		//Concurrent solvers would interleave their lines; they are
+		//reported below instead, in component order
+		if(parallel){
+			subConfig.verbose = false;
+			subConfig.metricsJSON = NULL;
+		}
+		LPSolver solver(sub, subConfig);
+		solver.solve();
+
+		//the whole problem carries its constant; the pieces don't
+		double shift = whole ? problem->constantTerm : 0;
+		lbs[c] = solver.lowerBound - shift;
+		ubs[c] = solver.upperBound - shift;
+		sols[c] = solver.bestSol;
+		componentMetrics[c] = solver.metrics;
+		if(!whole){
+			delete &sub->coeffs;
+			delete sub;
+		}
+	}
+
+	VectorXd sol(n);
+	sol(0) = 1;
+	double lb = problem->constantTerm, ub = problem->constantTerm;
+	for(uint32_t c=0;c<k;c++){
+		//each piece assumed its own x_0 = +1; flip it if it came out -1
+		double s = sols[c](0) >= 0 ? 1 : -1;
+		for(uint32_t b=0;b<components[c].size();b++)
+			sol(components[c][b]) = s*sols[c](b+1);
+		lb += lbs[c];
+		ub += ubs[c];
+		metrics.merge(componentMetrics[c]);
+		if(parallel && config.verbose)
+			printf("Component %u (%u variables): lower bound %f, upper bound %f after %u rounds\n", c, (uint32_t)components[c].size(), lbs[c], ubs[c], componentMetrics[c].rounds);
+	}
+
+	double score = problem->score(sol);
+	if(score > lowerBound){
+		lowerBound = score;
+		bestSol = sol;
+	}
+	upperBound = std::min(upperBound, ub);
+	if(parallel && config.metricsJSON != NULL){
+		//Rows each component's LP ended with
+		uint32_t rows = 0;
+		for(uint32_t c=0;c<k;c++)
+			if(!componentMetrics[c].history.empty()) rows += componentMetrics[c].history.back().rows;
+		fprintf(config.metricsJSON, "%s\n", metrics.roundJSON(lowerBound, upperBound, rows).c_str());
+		fflush(config.metricsJSON);
+	}
+	if(config.verbose)
+		printf("Decomposed solve: lower bound %f (components sum to %f), upper bound %f\n", lowerBound, lb, upperBound);
+}
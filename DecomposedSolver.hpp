@@ -0,0 +1,46 @@
+#pragma once
+
+#include "LPSolver.hpp"
+
+#include <vector>
+
+//Splits a problem into the connected components of its interaction graph
+//and solves each with its own LPSolver. Variable 0 is left out of the
+//graph: fixing it to +1 is no loss (flipping every variable keeps the
+//score), after which its terms are linear terms that don't connect
+//anything. Each component keeps a copy of variable 0 for those.
+//The LP then has sum |C|(|C|+1)/2 columns instead of n(n-1)/2.
+//
+//Single-variable components are solved directly; if there is just one
+//component, the problem is handed to one LPSolver as it is.
+class DecomposedSolver
+{
+ public:
+	Problem* problem;
+
+	//Sums over the components, plus the constant term
+	double lowerBound;
+	double upperBound;
+	VectorXd bestSol;
+
+	//Options for each component's solver. With config.parallelComponents
+	//the components are solved on parallel threads (config.threads of them).
+	//Those solvers then print nothing and write no metricsJSON lines. At
+	//the end, each component's bounds are printed in order, and the merged
+	//metrics go to metricsJSON as one line.
+	LPSolverConfig config;
+
+	//Totals over all the component solvers
+	SolverMetrics metrics;
+
+	//Variables (other than 0) of each component, ascending, largest component first
+	std::vector<std::vector<uint32_t>> components;
+
+	DecomposedSolver(Problem* p, const LPSolverConfig& config = LPSolverConfig());
+
+	void solve();
+
+  private:
+	//The problem restricted to variable 0 and 'vars', with constant 0
+	Problem* subproblem(const std::vector<uint32_t>& vars) const;
+};
@@ -0,0 +1,132 @@
+#include "GlpkBackend.hpp"
+#include "GlpkEnv.hpp"
+
+#include <stdio.h>
+
+GlpkBackend::GlpkBackend(bool interior) : interior(interior), lastInterior(interior) {
+	//Its environment lives until this thread exits
+	attachGlpkEnv();
+	lp = glp_create_prob();
+	glp_set_prob_name(lp, "CLQO"); //Name the problem
+	glp_set_obj_dir(lp, GLP_MAX);  //We maximize
+	
+	glp_init_smcp(&simplexParm);
+	simplexParm.meth = GLP_DUAL;
+	simplexParm.msg_lev = GLP_MSG_ERR;
+	glp_init_iptcp(&interiorParm);
+	interiorParm.msg_lev = GLP_MSG_ERR;
+}
+
+GlpkBackend::~GlpkBackend(){
+	glp_delete_prob(lp);
+}
+
+void GlpkBackend::addColumns(uint32_t n, double lower, double upper){
+	int first = glp_add_cols(lp, n);
+	for(uint32_t i=0;i<n;i++)
+		glp_set_col_bnds(lp, first+i, GLP_DB, lower, upper);
+}
+
+void GlpkBackend::setObjective(int col, double coef){
+	glp_set_obj_coef(lp, col, coef);
+}
+
+double GlpkBackend::objective(int col) const {
+	return glp_get_obj_coef(lp, col);
+}
+
+void GlpkBackend::addRow(uint32_t len, const int* indices, const double* values, double rightSide){
+	int row = glp_add_rows(lp, 1);
+	glp_set_mat_row(lp, row, len, indices, values);
+	glp_set_row_bnds(lp, row, GLP_LO, rightSide, 0.0);
+}
+
+void GlpkBackend::deleteRows(uint32_t count, const int* rows){
+	if(count)
+		glp_del_rows(lp, count, rows);
+}
+
+uint32_t GlpkBackend::numRows() const {
+	return glp_get_num_rows(lp);
+}
+
+uint32_t GlpkBackend::getRow(int row, int* indices, double* values, double& rightSide) const {
+	rightSide = glp_get_row_lb(lp, row);
+	return glp_get_mat_row(lp, row, indices, values);
+}
+
+LPStatus GlpkBackend::solve(){
+	lastInterior = interior;
+	if(interior){
+		int err = glp_interior(lp, &interiorParm);
+		if(err == GLP_EINSTAB){
+			fprintf(stderr, "'just' an interior point stability check failed; using last point.\n");
+			return LP_INACCURATE;
+		}
+		if(err != 0){
+			fprintf(stderr, "FAILED Error Code = %d\n", err);
+			return LP_FAILED;
+		}
+		return glp_ipt_status(lp) == GLP_OPT ? LP_OPTIMAL : LP_FAILED;
+	}
+	
+	int err = glp_simplex(lp, &simplexParm);
+	if(err == GLP_EITLIM){
+		//Stopped early with a dual feasible basis: its duals still bound
+		//the LP. Stopped before it had one, there is no bound yet, so the
+		//solve is finished without the limit.
+		if(glp_get_dual_stat(lp) == GLP_FEAS)
+			return LP_INACCURATE;
+		int limit = simplexParm.it_lim;
+		simplexParm.it_lim = INT_MAX;
+		err = glp_simplex(lp, &simplexParm);
+		simplexParm.it_lim = limit;
+	}
+	if(err != 0){
+		fprintf(stderr, "FAILED Error Code = %d\n", err);
+		return LP_FAILED;
+	}
+	if(glp_get_status(lp) != GLP_OPT){
+		fprintf(stderr, "Simplex Optimality FAILED\n");
+		return LP_FAILED;
+	}
+	return LP_OPTIMAL;
+}
+
+uint64_t GlpkBackend::iterations() const {
+	return glp_get_it_cnt(lp);
+}
+
+double GlpkBackend::objectiveValue() const {
+	return lastInterior ? glp_ipt_obj_val(lp) : glp_get_obj_val(lp);
+}
+
+double GlpkBackend::colPrimal(int col) const {
+	return lastInterior ? glp_ipt_col_prim(lp, col) : glp_get_col_prim(lp, col);
+}
+
+double GlpkBackend::rowSlack(int row) const {
+	double activity = lastInterior ? glp_ipt_row_prim(lp, row) : glp_get_row_prim(lp, row);
+	return activity - glp_get_row_lb(lp, row);
+}
+
+double GlpkBackend::rowDual(int row) const {
+	return lastInterior ? glp_ipt_row_dual(lp, row) : glp_get_row_dual(lp, row);
+}
+
+static BasisStatus basisStatus(int stat){
+	switch(stat){
+		case GLP_BS: return BASIS_BASIC;
+		case GLP_NL: return BASIS_LOWER;
+		case GLP_NU: return BASIS_UPPER;
+		default: return BASIS_UNKNOWN;
+	}
+}
+
+BasisStatus GlpkBackend::rowStatus(int row) const {
+	return lastInterior ? BASIS_UNKNOWN : basisStatus(glp_get_row_stat(lp, row));
+}
+
+BasisStatus GlpkBackend::colStatus(int col) const {
+	return lastInterior ? BASIS_UNKNOWN : basisStatus(glp_get_col_stat(lp, col));
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "LPBackend.hpp"
+
+#include <glpk.h> //Linear programming toolkit
+#include <limits.h>
+
+//LPBackend on GLPK, with either its dual simplex or its interior point
+//method. Rows and solutions map one to one onto the glp_prob.
+class GlpkBackend : public LPBackend
+{
+ public:
+	GlpkBackend(bool interior = false);
+	~GlpkBackend();
+
+	const char* name() const { return interior ? "glpk-interior" : "glpk-simplex"; }
+
+	void addColumns(uint32_t n, double lower, double upper);
+	void setObjective(int col, double coef);
+	double objective(int col) const;
+
+	void addRow(uint32_t len, const int* indices, const double* values, double rightSide);
+	void deleteRows(uint32_t count, const int* rows);
+	uint32_t numRows() const;
+	uint32_t getRow(int row, int* indices, double* values, double& rightSide) const;
+
+	LPStatus solve();
+	//Simplex iterations only: GLPK doesn't report interior point ones
+	uint64_t iterations() const;
+
+	double objectiveValue() const;
+	double colPrimal(int col) const;
+	double rowSlack(int row) const;
+	double rowDual(int row) const;
+	BasisStatus rowStatus(int row) const;
+	BasisStatus colStatus(int col) const;
+
+	bool setInterior(bool useInterior){ interior = useInterior; return true; }
+	//Simplex only: GLPK's interior point method has no iteration limit
+	bool setLimits(uint64_t maxIterations, double){
+		simplexParm.it_lim = maxIterations && maxIterations < INT_MAX ? maxIterations : INT_MAX;
+		return !interior;
+	}
+
+ private:
+	glp_prob* lp;
+	glp_smcp simplexParm;
+	glp_iptcp interiorParm;
+	bool interior;
+	//Which method produced the solution we hold
+	bool lastInterior;
+};
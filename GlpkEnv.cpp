@@ -0,0 +1,17 @@
+#include "GlpkEnv.hpp"
+
+#include <glpk.h>
+
+struct GlpkEnvGuard {
+	bool attached = false;
+	~GlpkEnvGuard(){
+		if(attached)
+			glp_free_env();
+	}
+};
+
+static thread_local GlpkEnvGuard envGuard;
+
+void attachGlpkEnv(){
+	envGuard.attached = true;
+}
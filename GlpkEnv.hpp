@@ -0,0 +1,13 @@
+#pragma once
+
+//GLPK keeps one environment per thread (when built with thread local
+//storage, as distribution packages are), created on first use.
+//glp_free_env() destroys the calling thread's environment together with
+//every problem object still in it, so no solver may call it while another
+//solver on the same thread is alive.
+//
+//Instead, every thread that creates GLPK objects calls attachGlpkEnv()
+//first. The environment is then freed once, when that thread exits. Any
+//number of solvers can be created and destroyed on a thread in the
+//meantime, and OpenMP workers keep theirs across parallel regions.
+void attachGlpkEnv();
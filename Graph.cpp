@@ -0,0 +1,78 @@
+#include "Graph.hpp"
+
+#include <algorithm>    // std::binary_search
+
+Graph::Graph(uint32_t nV) : n(nV), offsets(nV+1, 0), adj() {}
+
+Graph Graph::fromEdges(uint32_t n, const std::vector<std::pair<uint32_t,uint32_t>>& edges){
+	//Two stable bucket passes (by target, then by source) leave every
+	//adjacency list sorted, so duplicates can be dropped in one sweep.
+	std::vector<size_t> byTarget(n+1, 0);
+	for(auto& e : edges){
+		if(e.first == e.second) continue;
+		byTarget[e.first+1]++;
+		byTarget[e.second+1]++;
+	}
+	for(uint32_t v=0;v<n;v++) byTarget[v+1] += byTarget[v];
+
+	std::vector<uint32_t> sources(byTarget[n]);
+	std::vector<size_t> pos(byTarget.begin(), byTarget.end()-1);
+	for(auto& e : edges){
+		if(e.first == e.second) continue;
+		sources[pos[e.second]++] = e.first;
+		sources[pos[e.first]++] = e.second;
+	}
+
+	Graph g(n);
+	for(uint32_t t=0;t<n;t++)
+		for(size_t a=byTarget[t];a<byTarget[t+1];a++)
+			g.offsets[sources[a]+1]++;
+	for(uint32_t v=0;v<n;v++) g.offsets[v+1] += g.offsets[v];
+
+	g.adj.resize(g.offsets[n]);
+	pos.assign(g.offsets.begin(), g.offsets.end()-1);
+	for(uint32_t t=0;t<n;t++)
+		for(size_t a=byTarget[t];a<byTarget[t+1];a++)
+			g.adj[pos[sources[a]]++] = t;
+
+	//remove repeated edges, compacting in place
+	size_t out = 0;
+	for(uint32_t v=0;v<n;v++){
+		size_t start = g.offsets[v], end = g.offsets[v+1];
+		g.offsets[v] = out;
+		for(size_t a=start;a<end;a++){
+			if(a > start && g.adj[a] == g.adj[a-1]) continue;
+			g.adj[out++] = g.adj[a];
+		}
+	}
+	g.offsets[n] = out;
+	g.adj.resize(out);
+	g.adj.shrink_to_fit();
+
+	return g;
+}
+
+bool Graph::hasEdge(uint32_t u, uint32_t v) const {
+	return std::binary_search(adj.begin()+offsets[u], adj.begin()+offsets[u+1], v);
+}
+
+Graph Graph::complement() const {
+	Graph g(n);
+	for(uint32_t v=0;v<n;v++)
+		g.offsets[v+1] = g.offsets[v] + (n-1-degree(v));
+	g.adj.resize(g.offsets[n]);
+
+	//walk each sorted adjacency list alongside 0..n-1
+	for(uint32_t v=0;v<n;v++){
+		size_t a = offsets[v], out = g.offsets[v];
+		for(uint32_t u=0;u<n;u++){
+			if(a < offsets[v+1] && adj[a] == u){
+				a++;
+				continue;
+			}
+			if(u != v) g.adj[out++] = u;
+		}
+	}
+
+	return g;
+}
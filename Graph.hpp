@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+#include <utility>		// std::pair
+#include <stddef.h>     /* size_t */
+
+typedef unsigned int uint32_t;
+
+//An undirected graph in compressed sparse row (CSR) form. Vertices are
+//0..n-1. The neighbours of v are adj[offsets[v]] .. adj[offsets[v+1]-1],
+//sorted ascending, and every edge is stored once in each direction.
+class Graph
+{
+ public:
+	uint32_t n; //number of vertices
+
+	std::vector<size_t> offsets; //n+1 entries
+	std::vector<uint32_t> adj;   //2*numEdges() entries
+
+	//Initialize an edgeless graph on n vertices
+	Graph(uint32_t n);
+
+	//Build a graph from an edge list in O(n+m). Self loops and repeated
+	//edges (in either direction) are dropped.
+	static Graph fromEdges(uint32_t n, const std::vector<std::pair<uint32_t,uint32_t>>& edges);
+
+	size_t numEdges() const { return adj.size()/2; }
+	uint32_t degree(uint32_t v) const { return offsets[v+1] - offsets[v]; }
+
+	//Binary search in the adjacency of u
+	bool hasEdge(uint32_t u, uint32_t v) const;
+
+	//The complement graph. Takes O(n^2) time, which is linear in the size
+	//of g plus that of its complement, and only stores the complement's
+	//edges.
+	Graph complement() const;
+};
@@ -0,0 +1,22 @@
+#include "LPBackend.hpp"
+#include "GlpkBackend.hpp"
+#include "Pdlp.hpp"
+
+#include <string.h>
+
+LPBackend* createLPBackend(LPEngine engine){
+	switch(engine){
+		case LP_GLPK_INTERIOR: return new GlpkBackend(true);
+		case LP_PDLP: return new Pdlp();
+		case LP_GLPK_SIMPLEX:
+		default: return new GlpkBackend(false);
+	}
+}
+
+bool lpEngineFromName(const char* name, LPEngine& engine){
+	if(!strcmp(name, "glpk-simplex")) engine = LP_GLPK_SIMPLEX;
+	else if(!strcmp(name, "glpk-interior")) engine = LP_GLPK_INTERIOR;
+	else if(!strcmp(name, "pdlp")) engine = LP_PDLP;
+	else return false;
+	return true;
+}
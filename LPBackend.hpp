@@ -0,0 +1,88 @@
+#pragma once
+
+#include <stdint.h>
+
+//Which LP engine an LPSolver uses
+enum LPEngine {
+	LP_GLPK_SIMPLEX,  //GLPK's dual simplex, warm-started from the last basis
+	LP_GLPK_INTERIOR, //GLPK's interior point method, from scratch each solve
+	LP_PDLP           //Pdlp, first-order and approximate, for LPs too big to factor
+};
+
+enum LPStatus {
+	LP_OPTIMAL,
+	LP_INACCURATE, //a usable point, but the engine couldn't certify it optimal
+	LP_FAILED
+};
+
+//Where a row or column sits in the current basis
+enum BasisStatus {
+	BASIS_BASIC,
+	BASIS_LOWER,   //nonbasic at its lower bound
+	BASIS_UPPER,   //nonbasic at its upper bound
+	BASIS_UNKNOWN  //the engine has no basis (interior point)
+};
+
+//The linear program LPSolver builds: maximize c.x over columns boxed in
+//[lower, upper], subject to rows sum a_k x_k >= b that come and go between
+//solves. Rows and columns are 1-indexed, and arrays passed in are too (they
+//start at [1]), as in GLPK.
+//
+//Everything about how the LP is solved lives behind this interface, so
+//engines can be swapped per solver at runtime.
+class LPBackend
+{
+ public:
+	virtual ~LPBackend(){}
+
+	virtual const char* name() const = 0;
+
+	//Append n columns, each bounded to [lower, upper], with objective 0
+	virtual void addColumns(uint32_t n, double lower, double upper) = 0;
+	virtual void setObjective(int col, double coef) = 0;
+	virtual double objective(int col) const = 0;
+
+	//Append the row sum values[k]*x[indices[k]] >= rightSide, k = 1..len
+	virtual void addRow(uint32_t len, const int* indices, const double* values, double rightSide) = 0;
+	//Remove rows[1..count], given in ascending order. Later rows move down.
+	virtual void deleteRows(uint32_t count, const int* rows) = 0;
+	virtual uint32_t numRows() const = 0;
+	//A row as it was added: its entries into indices[1..] and values[1..],
+	//which need room for every column, and its right side. Returns the
+	//number of entries.
+	virtual uint32_t getRow(int row, int* indices, double* values, double& rightSide) const = 0;
+
+	//Solve starting from whatever state the last solve left
+	virtual LPStatus solve() = 0;
+	//Iterations over all solves so far
+	virtual uint64_t iterations() const = 0;
+	//Let the next solves stop after maxIterations (0: no limit) or, for
+	//engines that solve to a tolerance, at that relative tolerance (0: the
+	//engine's default). A solve cut short returns LP_INACCURATE, with its
+	//last point and duals. Engines that can't be limited return false.
+	virtual bool setLimits(uint64_t, double){ return false; }
+
+	//The last solution
+	virtual double objectiveValue() const = 0;
+	virtual double colPrimal(int col) const = 0;
+	//Row activity minus its right side
+	virtual double rowSlack(int row) const = 0;
+	//Dual value of a row, <= 0 for a binding >= row of a maximization
+	virtual double rowDual(int row) const = 0;
+	//How far the slack of a row may be off in the last solution: 0 for
+	//engines that solve exactly, up to rounding
+	virtual double slackAccuracy(int) const { return 0; }
+	virtual BasisStatus rowStatus(int row) const = 0;
+	virtual BasisStatus colStatus(int col) const = 0;
+	
+	//Engines with both a simplex and an interior point method use the one
+	//asked for from the next solve on; others return false
+	virtual bool setInterior(bool){ return false; }
+};
+
+//A new, empty LP for the given engine
+LPBackend* createLPBackend(LPEngine engine);
+
+//The engine called 'name' ("glpk-simplex", "glpk-interior", "pdlp");
+//false if there is none
+bool lpEngineFromName(const char* name, LPEngine& engine);
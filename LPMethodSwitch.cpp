@@ -0,0 +1,34 @@
+#include "LPMethodSwitch.hpp"
+
+bool LPMethodSwitch::choose(uint32_t churn, uint32_t rows, uint32_t cols){
+	sinceSimplex += churn;
+	double interiorWork = rows + cols;
+	
+	if(simplexRate < 0){
+		//Nothing measured yet: the first solve has no basis to reuse anyway
+		interior = false;
+	} else {
+		//A simplex solve now starts from the last simplex basis, so it has
+		//to catch up on every row changed since, as record() charges it
+		double simplexTime = simplexRate * (sinceSimplex + 1);
+		if(interiorRate < 0){
+			interior = simplexTime >= minSeconds && churn >= churnFraction * rows;
+		} else {
+			double interiorTime = interiorRate * interiorWork;
+			if(interior && simplexTime < margin * interiorTime)
+				interior = false;
+			else if(!interior && simplexTime >= minSeconds && interiorTime < margin * simplexTime)
+				interior = true;
+		}
+	}
+	work = interior ? interiorWork : sinceSimplex + 1;
+	return interior;
+}
+
+void LPMethodSwitch::record(double seconds){
+	double rate = seconds / work;
+	double& avg = interior ? interiorRate : simplexRate;
+	avg = avg < 0 ? rate : 0.5*avg + 0.5*rate;
+	if(!interior)
+		sinceSimplex = 0;
+}
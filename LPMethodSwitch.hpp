@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdint.h>
+
+//Picks, before each LP solve, between a warm-started dual simplex and a
+//cold interior point method, from the time each has been observed to take.
+//
+//A warm simplex re-solve costs roughly in proportion to how many rows
+//changed since the basis it starts from; an interior point solve starts
+//over and costs in proportion to the size of the LP. Each method's seconds
+//per unit of that work is tracked (decayed average), and the one predicted
+//cheaper at the current churn is used. Interior point is first tried only
+//once a solve with heavy churn is expected to be slow, so small LPs stay
+//on simplex.
+class LPMethodSwitch
+{
+ public:
+	//churnFraction: rows changed / rows at which interior point gets a first try
+	//minSeconds: don't leave simplex for solves predicted faster than this
+	//margin: switch only when the other method is predicted this much cheaper
+	LPMethodSwitch(double churnFraction = 0.5, double minSeconds = 0.05, double margin = 0.8)
+		: churnFraction(churnFraction), minSeconds(minSeconds), margin(margin),
+		simplexRate(-1), interiorRate(-1), sinceSimplex(0), interior(false) {}
+
+	//Whether the next solve should be interior point, given the rows added
+	//or removed since the last solve and the LP's size
+	bool choose(uint32_t churn, uint32_t rows, uint32_t cols);
+	//How long the solve just chosen for took
+	void record(double seconds);
+
+ private:
+	double churnFraction, minSeconds, margin;
+	//Seconds per unit of work, <0 until measured
+	double simplexRate, interiorRate;
+	//Rows changed since the last simplex basis
+	uint32_t sinceSimplex;
+	//The method chosen last, and the work it was given
+	bool interior;
+	double work;
+};
@@ -1,32 +1,13 @@
 #include "LPSolver.hpp"
 
-#include <chrono>
 #include <iostream>
 #include <algorithm>
-#include <random>
-
-#include <sys/time.h>
-
-#define PSD_EIGEN_TOL 0.0001
-#define MAX_TRIES_ROUNDING 20
-
-static float CONSTRAINT_SLACK_MINIMUM = 0.99;
-static float constraint_removal_slack = CONSTRAINT_SLACK_MINIMUM;
-static float IMPROVEMENT_SLACK_TIGHTENING = 0.001;
-static float SLACK_TIGHTENING_INCREMENT = 0.0;
-
-typedef unsigned long long timestamp_t;
-
-static timestamp_t
-get_timestamp ()
-{
-  struct timeval now;
-  gettimeofday (&now, NULL);
-  return  now.tv_usec + (timestamp_t)now.tv_sec * 1000000;
-}
 
 //Construct solver
-LPSolver::LPSolver(Problem* p) {
+LPSolver::LPSolver(Problem* p, const LPSolverConfig& cfg) : config(cfg),
+	methodSwitch(cfg.interiorChurnFraction, cfg.interiorMinSeconds, cfg.switchMargin), churn(0),
+	tightenings(0), stoppedEarly(false), solveInFull(false),
+	pairs(p->nQP), support(0), rng(cfg.seed) {
 	problem = p;
 	nQP = p->nQP;
 	nLP = nQP*(nQP-1)/2;
@@ -38,110 +19,179 @@ LPSolver::LPSolver(Problem* p) {
 	
 	//Establish an initial upper bound by summing abs of each coefficient
 	upperBound = p->constantTerm;
-	for(uint32_t i=0;i<nQP;i++){
-		for(uint32_t j=i+1;j<nQP;j++){
-			upperBound += fabs(p->coeffs(i,j));
+	std::vector<std::pair<uint32_t,uint32_t>> edges;
+	for(uint32_t j=0;j<nQP;j++){
+		for(SparseMatrix<double>::InnerIterator it(p->coeffs, j);it;++it){
+			upperBound += fabs(it.value());
+			if(it.value() != 0) edges.push_back({(uint32_t)it.row(), j});
 		}
 	}
+	support = Graph::fromEdges(nQP, edges);
 	
-	//Create GLPK instance
-	lp = glp_create_prob();
-#ifdef USE_INTERIOR
-	glp_init_iptcp(&parm);
-#else
-	glp_init_smcp(&parm);
-	parm.meth = GLP_DUAL;
-#endif
-	parm.msg_lev = GLP_MSG_ERR;
+	//Create the LP
+	lp.reset(createLPBackend(config.lpEngine));
+	switching = config.switchLPMethod && lp->setInterior(config.lpEngine == LP_GLPK_INTERIOR);
 	
 	//Allocate room for LP solution
-	currSol = std::vector<float>(nLP); 
-	
-	glp_set_prob_name(lp, "CLQO"); //Name the problem
-	glp_set_obj_dir(lp, GLP_MAX);  //We maximize
-	
-	//each column corresponds to a variable we (linearly) optimize over
-	glp_add_cols(lp, nLP);
-	for(uint32_t i=1;i<=nLP;i++){
-		//Each variable has DB (double bound) to [-1,+1]
-		glp_set_col_bnds(lp, i, GLP_DB, -1., 1.);
-		std::pair<int,int> xy = getQPVars(i);
-		
-		//Set objective weight
-		glp_set_obj_coef(lp, i, p->coeffs(xy.second, xy.first));
+	currSol = std::vector<double>(nLP); 
+	rowIndices = std::vector<int>(nLP+1);
+	rowValues = std::vector<double>(nLP+1);
+	boundCoef = std::vector<double>(nLP);
+	solMat = MatrixXd(nQP, nQP);
+	solMatScreen = ScreenWorkspace::Matrix(nQP, nQP);
+	
+	//each column corresponds to a variable we (linearly) optimize over,
+	//bounded to [-1,+1]
+	lp->addColumns(nLP, -1., 1.);
+	for(uint32_t x=1;x<nQP;x++){
+		for(SparseMatrix<double>::InnerIterator it(p->coeffs, x);it;++it){
+			//Set objective weight
+			lp->setObjective(pairs.index(x, it.row()), it.value());
+		}
 	}
 	
 	active_clauses = std::vector<constraint>();
+	
+	if(config.removal == REMOVE_ABOVE_THRESHOLD)
+		removal.reset(new ThresholdRemovalPolicy(config.removalSlackMinimum, config.removalSlackIncrement, config.removalStallImprovement));
+	else
+		removal.reset(new AgingRemovalPolicy(config.removalSlackRounds, config.maxRows, config.removalGraceRounds));
 }
 
-//Given a variable vi and vj, get the index of vij
-uint32_t LPSolver::getLPVar(uint32_t x, uint32_t y){
-	if(y == x) throw std::runtime_error(std::string("Bad LP: ")+std::to_string(x)+", "+std::to_string(y));
-	if(y > x) return getLPVar(y, x);
-	if(y >= nQP || x >= nQP) throw std::runtime_error(std::string("Bad LP: ")+std::to_string(x)+", "+std::to_string(y)+", "+std::to_string(nQP));
-	return 1 + y + x*(x-1)/2;
+void LPSolver::setRemovalPolicy(RemovalPolicy* policy){
+	removal.reset(policy);
 }
 
-//given vij, find i and j
-std::pair<uint32_t,uint32_t> LPSolver::getQPVars(uint32_t v){
-	if(v > nLP) throw std::runtime_error(std::string("Bad vQP: ")+std::to_string(v)+", "+std::to_string(nLP));
-	
-	uint32_t x = floor(sqrt(2*v)+1./2);
-	uint32_t y = v - 1 - x*(x-1)/2;
+bool LPSolver::addConstraint(uint32_t len, const int* indices, const double* values, double rightSide){
+	//The separators overlap (a violated triangle is both an odd cycle and a
+	//hypermetric inequality), so the same row can come from several
+	CanonicalRow row(len, indices, values, rightSide);
+	uint64_t signature = row.signature();
+	if(!activeRows.insert(std::move(row)).second)
+		return false;
+	lp->addRow(len, indices, values, rightSide);
+	churn++;
+	
+	RowInfo info = {signature, metrics.rounds, 0, 0., 0., 0.};
+	rowInfo.push_back(info);
+	metrics.count(COUNT_CUTS_ADDED);
+	//Removals are only forgotten when rows are next deleted, so check the
+	//window here too
+	auto removed = removedSignatures.find(info.signature);
+	if(config.rediscoveryRounds && removed != removedSignatures.end() && metrics.rounds - removed->second < config.rediscoveryRounds)
+		metrics.count(COUNT_CUTS_REDISCOVERED);
+	return true;
+}
+
+void LPSolver::deleteRows(std::vector<uint32_t>& rows){
+	if(rows.empty()) return;
+	std::sort(rows.begin(), rows.end());
 	
-	if(y >= x) throw std::runtime_error(std::string("Bad QP: ")+std::to_string(x)+", "+std::to_string(y)+", "+std::to_string(v));
+	//Backends take 1-indexed row numbers, from num[1]
+	std::vector<int> num(rows.size()+1);
+	for(uint32_t i=0;i<rows.size();i++){
+		num[i+1] = rows[i]+1;
+		double rightSide;
+		uint32_t len = lp->getRow(num[i+1], &rowIndices[0], &rowValues[0], rightSide);
+		activeRows.erase(CanonicalRow(len, &rowIndices[0], &rowValues[0], rightSide));
+		if(config.rediscoveryRounds)
+			removedSignatures[rowInfo[rows[i]].signature] = metrics.rounds;
+	}
+	//Forget removals from before the window
+	for(auto it=removedSignatures.begin();it!=removedSignatures.end();){
+		if(metrics.rounds - it->second >= config.rediscoveryRounds) it = removedSignatures.erase(it);
+		else ++it;
+	}
+	lp->deleteRows(rows.size(), &num[0]);
+	churn += rows.size();
 	
-	return std::pair<uint32_t,uint32_t>(x,y);
+	uint32_t kept = 0;
+	for(uint32_t r=0, i=0;r<rowInfo.size();r++){
+		if(i < rows.size() && rows[i] == r) i++;
+		else rowInfo[kept++] = rowInfo[r];
+	}
+	rowInfo.resize(kept);
+	metrics.count(COUNT_CUTS_REMOVED, rows.size());
+}
+
+void LPSolver::updateRowInfo(){
+	for(uint32_t r=0;r<rowInfo.size();r++){
+		RowInfo& info = rowInfo[r];
+		int i = r+1;
+		info.slack = lp->rowSlack(i);
+		info.dual = lp->rowDual(i);
+		info.dualAverage = 0.5*info.dualAverage + 0.5*fabs(info.dual);
+		//Approximate engines leave binding rows some slack: allow for their
+		//accuracy, and take a nonzero dual as binding too
+		double accuracy = lp->slackAccuracy(i);
+		bool binding = info.slack <= std::max(config.bindingTolerance, accuracy) || (accuracy > 0 && info.dual != 0);
+		if(!binding)
+			info.slackRounds++;
+		else
+			info.slackRounds = 0;
+	}
 }
 
+CanonicalRow::CanonicalRow(uint32_t len, const int* indices, const double* values, double rightSide) : rightSide(rightSide) {
+	for(uint32_t i=1;i<=len;i++)
+		if(values[i] != 0) entries.push_back({indices[i], values[i]});
+	std::sort(entries.begin(), entries.end());
+}
 
+uint64_t CanonicalRow::signature() const {
+	uint64_t h = std::hash<double>()(rightSide);
+	for(const std::pair<int,double>& e : entries)
+		h = (h ^ ((uint64_t)e.first * 0x9E3779B97F4A7C15ull ^ std::hash<double>()(e.second))) * 0xBF58476D1CE4E5B9ull;
+	return h;
+}
 
 //Given an assignment, find a minimal (but non necess. minimum) set of
 //rows/columns that has a constraint that's it violating.
 //If it's actually positive semidefinite, and there are not constraints
 //that it's violating, return the empty list. (Congrats! This means you
 //found the global optimum!) Will not use rows/cols from 'banned', sorted.
-std::vector<uint32_t>& LPSolver::nonPSDcore(std::vector<uint32_t>& banned){
+void LPSolver::nonPSDcore(const std::vector<uint32_t>& banned, std::vector<uint32_t>& core){
+	if(!config.floatScreen){
+		nonPSDcoreIn<double>(banned, core);
+		return;
+	}
+	nonPSDcoreIn<ScreenReal>(banned, core);
+	//Rounding can make a barely-PSD core look non-PSD; if double disagrees, search again in double
+	if(core.size() > 0 && isPSD(core)){
+		metrics.count(COUNT_SCREEN_REJECTS);
+		nonPSDcoreIn<double>(banned, core);
+	}
+}
+
+template<typename Real>
+void LPSolver::nonPSDcoreIn(const std::vector<uint32_t>& banned, std::vector<uint32_t>& core){
 	//Two phases: one where we add rows hoping to make it not PSD,
 	//and then later we remove rows to make it minimal.
 	
 	//Rows we're currently taking
-	std::vector<uint32_t>& core = *new std::vector<uint32_t>();
+	core.clear();
 	//Rows we have not taken
-	std::vector<uint32_t> notInCore;
+	std::vector<uint32_t>& notInCore = workspace.rows;
+	notInCore.clear();
 	for(uint32_t i=0;i<nQP;i++) notInCore.push_back(i);
 	
 	//Remove 'banned'. Must be in order.
 	for(uint32_t i=banned.size();i-->0;) notInCore.erase(notInCore.begin()+banned[i]);
 	
 	//put the rows in a random order
-	std::random_shuffle(notInCore.begin(), notInCore.end());
+	rng.shuffle(notInCore.begin(), notInCore.end());
 	
 	do{
 		uint32_t newRow = notInCore.back();
 		notInCore.pop_back();
 		core.push_back(newRow);
 		
-		MatrixXd& subMat = getSubmatrix(core);
-		//std::cout << subMat << std::endl;
-		
-		Eigen::SelfAdjointEigenSolver<MatrixXd> eig(subMat);
-		auto evals = eig.eigenvalues();
-		bool isPSD = true;
-		for(uint32_t i=0; i<evals.size(); i++){
-			if(evals[i] < -PSD_EIGEN_TOL){
-				isPSD = false;
-				break;
-			}
-		}
-		delete &subMat;
-		
-		if(isPSD){
+		if(isPSDIn<Real>(core)){
 			if(notInCore.size() > 0)
 				continue; //add more
 			else {
 				core.clear();
-				return core; //nothing nonPSD, return empty vector
+				return; //nothing nonPSD, return empty vector
 			}
 		} else {
 			//we found a non-PSD chunk!
@@ -156,69 +206,113 @@ std::vector<uint32_t>& LPSolver::nonPSDcore(std::vector<uint32_t>& banned){
 		//std::cout << "Pared down " << removedRow << std::endl;
 		core.erase(core.begin());
 		
-		MatrixXd& subMat = getSubmatrix(core);
-		//std::cout << subMat << std::endl;
-		
-		Eigen::SelfAdjointEigenSolver<MatrixXd> eig(subMat);
-		auto evals = eig.eigenvalues();
-		bool isPSD = true;
-		for(uint32_t i=0; i<evals.size(); i++){
-			if(evals[i] < -PSD_EIGEN_TOL){
-				isPSD = false;
-				break;
-			}
-		}
-		delete &subMat;
-		
-		if(isPSD) //the row we removed was necessary for non-PSD-ness, add it back in
+		if(isPSDIn<Real>(core)) //the row we removed was necessary for non-PSD-ness, add it back in
 			core.push_back(removedRow);
 		//else great, we didn't need it. do nothing and repeat.
 	}
-	
-	return core;
 }
 
-MatrixXd& LPSolver::getSubmatrix(std::vector<uint32_t> rows){
-	
-	MatrixXd& result = *new MatrixXd(rows.size(), rows.size());
-	for(uint32_t i=0;i<rows.size();i++){
-		result(i,i) = 1;
-		
-		for(uint32_t j=i+1;j<rows.size();j++)
-			result(j,i) = result(i,j) = currSol[getLPVar(rows[i],rows[j])-1];
+//The copy of the LP solution, and the scratch space, in each precision
+template<typename Real> struct ScreenState;
+template<> struct ScreenState<double> {
+	static const MatrixXd& solution(const MatrixXd& solMat, const ScreenWorkspace::Matrix&){ return solMat; }
+	static Workspace& workspace(Workspace& ws, ScreenWorkspace&){ return ws; }
+};
+template<> struct ScreenState<float> {
+	static const ScreenWorkspace::Matrix& solution(const MatrixXd&, const ScreenWorkspace::Matrix& screen){ return screen; }
+	static ScreenWorkspace& workspace(Workspace&, ScreenWorkspace& ws){ return ws; }
+};
+
+//Copy rows x rows of 'full' into 'result', which must already be that size.
+//Gathers straight from the columns: one load per entry.
+template<typename MatrixT>
+static void gatherSubmatrix(const MatrixT& full, const std::vector<uint32_t>& rows, MatrixT& result){
+	uint32_t k = rows.size();
+	for(uint32_t j=0;j<k;j++){
+		const typename MatrixT::Scalar* col = full.col(rows[j]).data();
+		for(uint32_t i=0;i<k;i++)
+			result(i,j) = col[rows[i]];
 	}
-	
-	return result;
 }
 
-MatrixXd& LPSolver::getMatrix(){
-	MatrixXd& result = *new MatrixXd(nQP, nQP);
+template<typename Real>
+bool LPSolver::isPSDIn(const std::vector<uint32_t>& rows){
+	WorkspaceT<Real>& ws = ScreenState<Real>::workspace(workspace, screenWorkspace);
+	typename WorkspaceT<Real>::Matrix& subMat = ws.matrix(rows.size());
+	gatherSubmatrix(ScreenState<Real>::solution(solMat, solMatScreen), rows, subMat);
+	//std::cout << subMat << std::endl;
+	
+	auto& eig = ws.eigenSolver(rows.size());
+	eig.compute(subMat, Eigen::EigenvaluesOnly);
+	metrics.count(COUNT_EIGEN_SOLVES);
+	auto& evals = eig.eigenvalues();
+	for(uint32_t i=0; i<evals.size(); i++){
+		if(evals[i] < -config.psdTolerance)
+			return false;
+	}
+	return true;
+}
+
+bool LPSolver::isPSD(const std::vector<uint32_t>& rows){
+	return isPSDIn<double>(rows);
+}
+
+void LPSolver::getSubmatrix(const std::vector<uint32_t>& rows, MatrixXd& result){
+	gatherSubmatrix(solMat, rows, result);
+}
+
+void LPSolver::cacheSolution(){
 	for(uint32_t i=0;i<nQP;i++){
-		result(i,i) = 1;
+		solMat(i,i) = 1;
 		
 		for(uint32_t j=i+1;j<nQP;j++)
-			result(j,i) = result(i,j) = currSol[getLPVar(i,j)-1];
+			solMat(j,i) = solMat(i,j) = currSol[pairs.index(j,i)-1];
 	}
-	
-	return result;
+	if(config.floatScreen)
+		solMatScreen = solMat.cast<ScreenReal>();
 }
 
-float LPSolver::scoreRelaxation(){
-	float score = problem->constantTerm;
-	for(uint32_t i=0;i<nQP;i++){
-		for(uint32_t j=i+1;j<nQP;j++)
-			score += currSol[getLPVar(i,j)-1] * problem->coeffs(i,j);
+double LPSolver::scoreRelaxation(){
+	double score = problem->constantTerm;
+	for(uint32_t j=1;j<nQP;j++){
+		for(SparseMatrix<double>::InnerIterator it(problem->coeffs, j);it;++it)
+			score += currSol[pairs.index(j,it.row())-1] * it.value();
 	}
 	return score;
 }
 
+//Weak duality: for any mu >= 0 and x in the box with A x >= b,
+//c.x <= c.x + mu.(A x - b) <= sum_j |c_j + (A^T mu)_j| - mu.b
+//as every column is in [-1,1]. Row duals are <= 0 for a binding row of
+//the maximization, so mu = max(0, -dual); a dual of the wrong sign only
+//costs tightness.
+double LPSolver::certifiedBound(){
+	for(uint32_t j=0;j<nLP;j++)
+		boundCoef[j] = lp->objective(j+1);
+	double bound = problem->constantTerm;
+	uint32_t rows = lp->numRows();
+	for(uint32_t i=1;i<=rows;i++){
+		double mu = -lp->rowDual(i);
+		if(mu <= 0) continue;
+		double rightSide;
+		uint32_t len = lp->getRow(i, &rowIndices[0], &rowValues[0], rightSide);
+		for(uint32_t k=1;k<=len;k++)
+			boundCoef[rowIndices[k]-1] += mu*rowValues[k];
+		bound -= mu*rightSide;
+	}
+	for(uint32_t j=0;j<nLP;j++)
+		bound += fabs(boundCoef[j]);
+	return bound;
+}
+
 void LPSolver::roundToSol(){//TODO write the solution to the problem
 	
 	//TODO call to an actual SDP solver
 	
-	MatrixXd& solMat = getMatrix();
+	MatrixXd solMat = this->solMat;
 	
-	std::cout << "The matrix Sol:" << std::endl << solMat << std::endl;
+	if(config.verbose)
+		std::cout << "The matrix Sol:" << std::endl << solMat << std::endl;
 	
 	//for now --
 	//Reduce 'magnitude' slightly to make PSD
@@ -229,23 +323,21 @@ void LPSolver::roundToSol(){//TODO write the solution to the problem
 	solMat *= -1. / (-1 + minEigenvalue);
 	solMat += MatrixXd::Identity(nQP, nQP) * (minEigenvalue / (-1 + minEigenvalue));
 	
-	std::cout << "SDP-ified Sol:" << std::endl;
-	
-	std::cout << solMat << std::endl;
+	if(config.verbose){
+		std::cout << "SDP-ified Sol:" << std::endl;
+		std::cout << solMat << std::endl;
+	}
 	Eigen::LLT<MatrixXd> lltOfA(solMat); // compute the Cholesky decomposition of A
 	MatrixXd L = lltOfA.matrixL(); // retrieve factor L  in the decomposition
 	// The previous two lines can also be written as "L = A.llt().matrixL()"
-	std::cout << "The Cholesky factor L is" << std::endl << L << std::endl;
-	
-	delete &solMat;
+	if(config.verbose)
+		std::cout << "The Cholesky factor L is" << std::endl << L << std::endl;
 	
-	for(int tries=0; tries<MAX_TRIES_ROUNDING; tries++){
+	for(uint32_t tries=0; tries<config.roundingTries; tries++){
 		//generate random dot vector
 		VectorXd v(nQP);
-		std::default_random_engine generator(std::chrono::high_resolution_clock::now().time_since_epoch().count());
-		std::normal_distribution<double> distribution(0.0,1.0);
 		for(uint32_t i=0;i<nQP;i++){
-			v(i) = distribution(generator);
+			v(i) = rng.normal();
 			if(i==0) v(i) = fabs(v(i)); //normalize solution to start with "1"
 		}
 		
@@ -259,151 +351,224 @@ void LPSolver::roundToSol(){//TODO write the solution to the problem
 			printf("%f, ", resultVec(i));
 		puts("");*/
 		
-		printf("Score = %f\n", problem->score(resultVec));
+		double score = problem->score(resultVec);
+		if(config.verbose)
+			printf("Score = %f\n", score);
+		if(score > lowerBound){
+			lowerBound = score;
+			bestSol = resultVec;
+		}
 	}
 }
 
 void LPSolver::solve(){
-	int constraintsEver = 0;
-	
-	double coreFindTime = 0.0, coreFindTotal = 0.0, simplexTime = 0.0, simplexTotal = 0.0, clearTime, clearTotal = 0.0;
-	
 	std::vector<uint32_t> core_banned = std::vector<uint32_t>();
+	std::vector<uint32_t> core;
+	std::vector<double> constraint;
 	
-solve:
-	/* solve problem */
-	timestamp_t simplexTimeStart = get_timestamp();
-	int simplex_err = 
-#ifdef USE_INTERIOR
-	glp_interior(lp, &parm);
-#else
-	glp_simplex(lp, &parm);
-#endif
-	timestamp_t simplexTimeEnd = get_timestamp();
-	simplexTotal += simplexTime = (simplexTimeEnd - simplexTimeStart) / 1000000.0L;
-	if(simplex_err != 0) {
-		printf("FAILED Error Code = %d\n", simplex_err);
-		if(simplex_err == GLP_EINSTAB){
-			printf("'just' an interior point stability check failed; using last point.\n");
-		} else {
-			exit(1);
-		}
-	}
-#ifndef USE_INTERIOR
-	if(glp_get_status(lp) != GLP_OPT) {
-		printf("Simplex Optimality FAILED");
-		exit(2);
-	}
-#endif
+	//Solves in full in a row with nothing to separate at an inexact point
+	const uint32_t MAX_FULL_SOLVES = 3;
+	uint32_t fullSolves = 0;
 	
-	for(uint32_t i=1;i<=nLP;i++){
-	#ifdef USE_INTERIOR
-		currSol[i-1] = glp_ipt_col_prim(lp, i);//glp_get_col_prim(lp, i);
-	#else
-		currSol[i-1] = glp_get_col_prim(lp, i);
-	#endif
-	}
-	float oldUpperBound = upperBound;
-	float newScore = scoreRelaxation();
-	upperBound = std::min(upperBound, newScore);
-	printf("Bound: %.6f -> %.6f\n", oldUpperBound, newScore);
-	
-	float improvement = oldUpperBound - upperBound;
-	if(improvement < IMPROVEMENT_SLACK_TIGHTENING)
-		constraint_removal_slack += SLACK_TIGHTENING_INCREMENT;
-	else
-		constraint_removal_slack = CONSTRAINT_SLACK_MINIMUM;
-	
-	timestamp_t clearStart = get_timestamp();
-	//Remove non-binding constraints. Could be readded later, but unlikely
-	uint32_t rowNum = glp_get_num_rows(lp);
-	for(int i=rowNum;i>0;i--){
-		double slack = glp_get_row_prim(lp,i)-glp_get_row_lb(lp,i);
-		if(slack > constraint_removal_slack){
-			//printf("Deleting %d of %d, slack=%f\n", i, rowNum, slack);
-			glp_del_rows(lp, 1, (const int*)&((&i)[-1]));
+	while(true){
+		ScopedTrace roundTrace(config.trace, "round");
+		
+		//Whether this round's LP point may be short of optimal
+		bool inexact = false;
+		
+		/* solve problem */
+		{
+			ScopedTimer timer(metrics, PHASE_LP_SOLVE);
+			ScopedTrace trace(config.trace, "lp_solve");
+			if(switching){
+				bool interior = methodSwitch.choose(churn, lp->numRows(), nLP);
+				lp->setInterior(interior);
+				if(interior) metrics.count(COUNT_INTERIOR_SOLVES);
+			}
+			double tolerance = 0;
+			if(config.earlyTermination){
+				//Points from solves cut short make poor separation points, so
+				//a cut short solve also earns the next one more effort. The
+				//first solve, with no rows yet, gets the loose limits.
+				uint32_t rows = lp->numRows();
+				if(rows > 0 && (churn <= config.stableChurnFraction * rows || stoppedEarly))
+					tightenings = std::min(tightenings+1, 20u);
+				else
+					tightenings = 0;
+				if(solveInFull){
+					lp->setLimits(0, config.lpTightTolerance);
+				} else {
+					tolerance = std::max(config.lpTightTolerance, config.lpLooseTolerance * pow(0.1, tightenings));
+					//An engine that doesn't take the limits solves in full
+					if(!lp->setLimits((uint64_t)config.lpIterationLimit << tightenings, tolerance))
+						tolerance = 0;
+				}
+			}
+			churn = 0;
+			uint64_t itersBefore = lp->iterations();
+			LPStatus status = lp->solve();
+			metrics.count(COUNT_LP_ITERATIONS, lp->iterations() - itersBefore);
+			if(status == LP_FAILED){
+				fprintf(stderr, "LP solve with %s FAILED\n", lp->name());
+				exit(1);
+			}
+			if(config.earlyTermination){
+				stoppedEarly = !solveInFull && status == LP_INACCURATE;
+				if(stoppedEarly)
+					metrics.count(COUNT_LP_EARLY_STOPS);
+			}
+			//A solve in full can come back inaccurate too, e.g. at the
+			//engine's own iteration limit
+			inexact = status == LP_INACCURATE || tolerance > config.lpTightTolerance;
+			solveInFull = false;
 		}
-	}
-	timestamp_t clearEnd = get_timestamp();
-	clearTotal += clearTime = (clearEnd-clearStart) / 1000000.0L;
-	
-	core_banned.clear();
-	bool constraintFound = false;
-	
-	timestamp_t timeCoreStart = get_timestamp();
-findcore:
-	std::vector<uint32_t> core = nonPSDcore(core_banned);
-	
-	if(core.size() != 0){
-		//We have a core, identify a new constraint
-		MatrixXd coreMat = getSubmatrix(core);
-		std::vector<double>& constraint = findConstraint(coreMat);
+		//One LP solve per round, so this round's time is its time
+		if(switching)
+			methodSwitch.record(metrics.roundTime[PHASE_LP_SOLVE]);
 		
-		if(constraint.size() != 0){
-			
-			//apply the constraint
-			//constraint consists of linear terms on the
-			//(core.size() choose 2) variables, preceded by
-			//a constant term. The variables are in the submatrix,
-			//and they'll need to mapped back "up" to the full matrix:
-			//turn ij into i and j, and then map i and j to the larger matrix,
-			//and then map back down to ij.
-			glp_add_rows(lp, 1);
-			rowNum = glp_get_num_rows(lp);
+		for(uint32_t i=1;i<=nLP;i++)
+			currSol[i-1] = lp->colPrimal(i);
+		cacheSolution();
+		double oldUpperBound = upperBound;
+		//The duals, not the primal point, give the bound, so that it holds
+		//after inexact solves too
+		double newScore = certifiedBound();
+		upperBound = std::min(upperBound, newScore);
+		if(config.verbose)
+			printf("Bound: %.6f -> %.6f (LP point scores %.6f)\n", oldUpperBound, newScore, scoreRelaxation());
+		
+		//Remove constraints the policy considers done with
+		{
+			ScopedTimer timer(metrics, PHASE_ROW_DELETION);
+			ScopedTrace trace(config.trace, "row_deletion");
+			updateRowInfo();
+			RoundState state = {metrics.rounds, oldUpperBound - upperBound};
+			rowsToRemove.clear();
+			removal->select(rowInfo, state, rowsToRemove);
+			deleteRows(rowsToRemove);
+		}
+		
+		core_banned.clear();
+		bool constraintFound = false;
+		
+		//Cheap separation straight from the LP solution
+		{
+			ScopedTimer timer(metrics, PHASE_CONSTRAINT_GEN);
+			if(config.separateOddCycles){
+				ScopedTrace trace(config.trace, "separate_odd_cycles");
+				constraintFound |= separateOddCycles() > 0;
+			}
+			if(config.separateHypermetric){
+				ScopedTrace trace(config.trace, "separate_hypermetric");
+				constraintFound |= separateHypermetric() > 0;
+			}
+		}
+		
+		while(true){
+			{
+				ScopedTimer timer(metrics, PHASE_CORE_SEARCH);
+				ScopedTrace trace(config.trace, "core_search");
+				nonPSDcore(core_banned, core);
+			}
+			if(core.size() == 0)
+				break;
 			
-			constraintsEver++;
-			constraintFound = true;
+			//We have a core, identify a new constraint
+			ScopedTimer timer(metrics, PHASE_CONSTRAINT_GEN);
+			ScopedTrace trace(config.trace, "find_constraint");
+			MatrixXd& coreMat = workspace.matrix(core.size());
+			getSubmatrix(core, coreMat);
+			bool found = findConstraint(coreMat, constraint);
 			
-			//build indices to pass to GLPK's sparse representation
-			uint32_t indices[constraint.size()]; //size+1 for 1 indexing, (size+1)-1 for ignoring constant
-			for(uint32_t v=0; v<constraint.size()-1; v++){
-				std::pair<uint32_t,uint32_t> ij = getQPVars(1+v);
-				uint32_t largeI = core[ij.first], largeJ = core[ij.second];
-				//printf("(%d,%d)*%f + ",largeI,largeJ,constraint[v+1]);
-				uint32_t largeIJ = getLPVar(largeI, largeJ);
-				indices[1+v] = largeIJ;
+			if(found){
+				
+				//apply the constraint
+				//constraint consists of linear terms on the
+				//(core.size() choose 2) variables, preceded by
+				//a constant term. The variables are in the submatrix,
+				//and they'll need to mapped back "up" to the full matrix:
+				//turn ij into i and j, and then map i and j to the larger matrix,
+				//and then map back down to ij.
+				
+				//build indices to pass to GLPK's sparse representation
+				int indices[constraint.size()]; //size+1 for 1 indexing, (size+1)-1 for ignoring constant
+				uint32_t v = 1;
+				for(uint32_t i=1; i<core.size(); i++){
+					for(uint32_t j=0; j<i; j++){
+						//printf("(%d,%d)*%f + ",core[i],core[j],constraint[v]);
+						indices[v++] = pairs(core[i], core[j]);
+					}
+				}
+				//printf(" <= %f\n", constraint[0]); 
+				//sum[ coeff[i]*x[i] ] >= coeff[0]. A row the separators
+				//already added doesn't count as new.
+				constraintFound |= addConstraint(constraint.size()-1, indices, &(constraint[0]), constraint[0]);
+			} else {
+				//We couldn't find a constraint for our submatrix. Let it slide
 			}
-			//printf(" <= %f\n", constraint[0]); 
-			//sum[ coeff[i]*x[i] ] >= coeff[0]
-			glp_set_mat_row(lp, rowNum, constraint.size()-1, (const int*)indices, &(constraint[0]));
-			glp_set_row_bnds(lp, rowNum, GLP_LO, constraint[0], 0.0);
-			delete &constraint;
-		} else {
-			//We couldn't find a constraint for our submatrix. Let it slide
+			
+			core_banned.push_back(core[0]);
+			//core_banned.push_back(core[1]);
+			//core_banned.push_back(core[2]);
+			std::sort(core_banned.begin(), core_banned.end());
 		}
 		
-		core_banned.push_back(core[0]);
-		//core_banned.push_back(core[1]);
-		//core_banned.push_back(core[2]);
-		std::sort(core_banned.begin(), core_banned.end());
-		goto findcore;
-	}
-	timestamp_t timeCoreEnd = get_timestamp();
-	coreFindTotal += coreFindTime = (timeCoreEnd - timeCoreStart) / 1000000.0L;
-	
-	printf("%d constraints (%d ever)-- core = %.3f, simp = %.3f (this %.3f), del = %.3f (this %.3f) slk= %.3f\n", rowNum, constraintsEver, coreFindTotal, simplexTotal, simplexTime, clearTotal, clearTime, constraint_removal_slack);
-	
-	//We have at this point exhausted (enough) constraints to add.
-	if(core_banned.size() == 0){
-		std::cout << "Global optimum found! Solution:" << std::endl;
-		bestSol(0) = 1;
-		for(uint32_t i=1;i<nQP;i++){
-			bestSol(i) = lround(currSol[getLPVar(0,i)-1]);
+		uint32_t rowNum = lp->numRows();
+		const double* total = metrics.totalTime;
+		if(config.verbose)
+			printf("%d constraints (%llu ever)-- core = %.3f, gen = %.3f, simp = %.3f (this %.3f), del = %.3f (this %.3f, %llu rows)\n", rowNum, (unsigned long long)metrics.totalCount[COUNT_CUTS_ADDED], total[PHASE_CORE_SEARCH], total[PHASE_CONSTRAINT_GEN], total[PHASE_LP_SOLVE], metrics.roundTime[PHASE_LP_SOLVE], total[PHASE_ROW_DELETION], metrics.roundTime[PHASE_ROW_DELETION], (unsigned long long)metrics.roundCount[COUNT_CUTS_REMOVED]);
+		
+		//Nothing to separate at a point the LP stopped short of: solve in
+		//full before concluding anything from it. An engine that stays
+		//inaccurate in full gets a few more tries, then its point is used.
+		bool roundLimit = config.maxRounds != 0 && metrics.rounds+1 >= config.maxRounds;
+		if(constraintFound)
+			fullSolves = 0;
+		if(!constraintFound && inexact && !roundLimit && fullSolves < MAX_FULL_SOLVES){
+			solveInFull = true;
+			fullSolves++;
+			metrics.endRound(config.metricsJSON, lowerBound, upperBound, rowNum);
+			continue;
 		}
-		std::cout << bestSol;
 		
-		float score = problem->score(bestSol);
-		printf("Score = %f\n", score);
-	} else if(!constraintFound){
-		std::cout << "Unable to identify new constraints. Rounding off." << std::endl;
-		roundToSol();
-		return;
-	} else {
-		goto solve;
+		//We have at this point exhausted (enough) constraints to add. If
+		//the LP point is integral, it is an assignment.
+		bool integral = core_banned.size() == 0 && !constraintFound;
+		for(uint32_t i=0;i<nLP && integral;i++)
+			integral = fabs(fabs(currSol[i]) - 1) <= config.integralTolerance;
+		if(integral){
+			VectorXd sol(nQP);
+			sol(0) = 1;
+			for(uint32_t i=1;i<nQP;i++){
+				sol(i) = copysign(1., currSol[pairs.index(i,0)-1]);
+			}
+			double score = problem->score(sol);
+			if(score > lowerBound){
+				lowerBound = score;
+				bestSol = sol;
+			}
+			if(config.verbose){
+				std::cout << "Global optimum found! Solution:" << std::endl;
+				std::cout << sol;
+				printf("Score = %f\n", score);
+			}
+			metrics.endRound(config.metricsJSON, lowerBound, upperBound, rowNum);
+			return;
+		} else if(!constraintFound || roundLimit){
+			if(config.verbose){
+				if(constraintFound)
+					std::cout << "Round limit reached. Rounding off." << std::endl;
+				else
+					std::cout << "Unable to identify new constraints. Rounding off." << std::endl;
+			}
+			{
+				ScopedTimer timer(metrics, PHASE_ROUNDING);
+				ScopedTrace trace(config.trace, "rounding");
+				roundToSol();
+			}
+			metrics.endRound(config.metricsJSON, lowerBound, upperBound, rowNum);
+			return;
+		}
+		metrics.endRound(config.metricsJSON, lowerBound, upperBound, rowNum);
 	}
-}
-
-LPSolver::~LPSolver(){
-	glp_delete_prob(lp);
-	glp_free_env();
 }
\ No newline at end of file
@@ -1,17 +1,158 @@
 #pragma once
 
 #include "Problem.hpp"
-#include <glpk.h> //Linear programming toolkit
+#include "PairIndex.hpp"
+#include "Workspace.hpp"
+#include "Metrics.hpp"
+#include "Trace.hpp"
+#include "Rng.hpp"
+#include "RemovalPolicy.hpp"
+#include "LPBackend.hpp"
+#include "LPMethodSwitch.hpp"
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
 #include <Eigen/Sparse>
 
-//#define USE_INTERIOR
-
 //Represents a constraint: (a*x[0] + b*x[1] + .. <= rightSide)
 typedef struct {
-	Eigen::SparseVector<float> coeffs;
-	float rightSide;
+	Eigen::SparseVector<double> coeffs;
+	double rightSide;
 } constraint;
 
+//A row of the LP as its nonzero (column, coefficient) entries in column
+//order and its right side, so that rows compare equal whatever order
+//their entries came in
+struct CanonicalRow {
+	std::vector<std::pair<int,double>> entries;
+	double rightSide;
+	
+	//From entries [1..len], as LPBackend takes them
+	CanonicalRow(uint32_t len, const int* indices, const double* values, double rightSide);
+	bool operator==(const CanonicalRow& other) const { return rightSide == other.rightSide && entries == other.entries; }
+	//Hash of the row, kept as RowInfo::signature
+	uint64_t signature() const;
+};
+
+struct CanonicalRowHash {
+	size_t operator()(const CanonicalRow& row) const { return row.signature(); }
+};
+
+//Precision of the eigenvalue screens in the core search. Bounds, scores
+//and cuts are always double.
+typedef float ScreenReal;
+typedef WorkspaceT<ScreenReal> ScreenWorkspace;
+
+//Which RemovalPolicy an LPSolver starts with
+enum RemovalRule {
+	REMOVE_AGED,            //AgingRemovalPolicy
+	REMOVE_ABOVE_THRESHOLD  //ThresholdRemovalPolicy, the original rule
+};
+
+//Tuning options for an LPSolver
+struct LPSolverConfig {
+	//Engine the LP relaxation is solved with
+	LPEngine lpEngine = LP_GLPK_SIMPLEX;
+	//If the engine has both simplex and interior point, pick one before
+	//each solve from the measured LP times and row churn (LPMethodSwitch).
+	//Interior point gets a first try once the rows changed reach
+	//interiorChurnFraction of all rows and a simplex solve is predicted
+	//to take interiorMinSeconds; after that the method predicted cheaper
+	//by switchMargin wins.
+	bool switchLPMethod = false;
+	double interiorChurnFraction = 0.5;
+	double interiorMinSeconds = 0.05;
+	double switchMargin = 0.8;
+	
+	//Stop each round's LP solve early, after lpIterationLimit iterations
+	//or (for engines that solve to a tolerance) at lpLooseTolerance, and
+	//separate from the point it reached. Each round where at most
+	//stableChurnFraction of the rows changed, or after a solve that was cut
+	//short, doubles the limit and cuts the tolerance tenfold, down to
+	//lpTightTolerance; other rounds go back to the loose limits. pdlp
+	//takes both limits and glpk-simplex the iteration limit. A dual
+	//simplex's intermediate points are primal infeasible and may separate
+	//poorly enough to cost more rounds than they save, so measure before
+	//using this with the default engine.
+	//Before stopping for lack of cuts, the LP is solved once more in full.
+	bool earlyTermination = false;
+	uint32_t lpIterationLimit = 200;
+	double lpLooseTolerance = 1e-4;
+	double lpTightTolerance = 1e-6;
+	double stableChurnFraction = 0.05;
+	
+	//Each round, search the LP solution directly for violated (2q+1)-clique
+	//and hypermetric inequalities before falling back to the core search
+	bool separateHypermetric = true;
+	//Largest support that search grows b to, and most cuts it adds per round
+	uint32_t hypermetricMaxSupport = 9;
+	uint32_t hypermetricMaxCuts = 200;
+	
+	//Each round, separate odd-cycle inequalities on the support graph of
+	//the problem exactly, by shortest paths; and the most cuts that adds
+	bool separateOddCycles = true;
+	uint32_t oddCycleMaxCuts = 200;
+	
+	//How much a heuristic cut must be violated by (in b^T X b) to be added
+	double minCutViolation = 1e-4;
+	
+	//Worker threads for parallel separation. 0 means the OpenMP default
+	uint32_t threads = 0;
+	
+	//If set, the solver writes one JSON object per round here
+	FILE* metricsJSON = NULL;
+	
+	//If set, rounds, separation calls and worker tasks are recorded here
+	TraceRecorder* trace = NULL;
+	
+	//Print progress and solutions to stdout
+	bool verbose = true;
+	
+	//Stop adding cuts and round off after this many rounds. 0 means no limit
+	uint32_t maxRounds = 0;
+	
+	//Seed for all of the solver's randomness; the same seed gives the same run
+	uint64_t seed = 0;
+	
+	//DecomposedSolver: solve independent components on parallel threads
+	bool parallelComponents = false;
+	
+	//Grow and shrink candidate cores with single precision eigensolves
+	//(ScreenReal), and check only the final core in double
+	bool floatScreen = true;
+	//A core is PSD when its smallest eigenvalue is at least -psdTolerance
+	double psdTolerance = 1e-4;
+	//Random hyperplanes tried each time the relaxation is rounded
+	uint32_t roundingTries = 20;
+	//When nothing is left to separate, the LP point is read off as an
+	//assignment if every entry is within this of +-1; otherwise it is
+	//rounded like any other
+	double integralTolerance = 1e-6;
+	
+	//How rows are dropped after each LP solve. A row counts as binding when
+	//its slack is at most bindingTolerance, or, for approximate engines,
+	//within the engine's accuracy for it or with a nonzero dual.
+	RemovalRule removal = REMOVE_AGED;
+	double bindingTolerance = 1e-7;
+	//REMOVE_AGED: drop rows after this many non-binding rounds, and keep
+	//at most maxRows rows (0: no cap), but don't drop rows added in the
+	//last removalGraceRounds rounds to meet it
+	uint32_t removalSlackRounds = 5;
+	uint32_t maxRows = 0;
+	uint32_t removalGraceRounds = 2;
+	//REMOVE_ABOVE_THRESHOLD: drop rows with slack above the threshold,
+	//which starts at removalSlackMinimum and grows by removalSlackIncrement
+	//each round the bound improves by less than removalStallImprovement
+	double removalSlackMinimum = 0.99;
+	double removalSlackIncrement = 0.0;
+	double removalStallImprovement = 0.001;
+	//A cut added again within rediscoveryRounds rounds of its removal
+	//counts as rediscovered (cuts_rediscovered). Only that window of
+	//removals is remembered, so the record stays bounded under heavy
+	//removal. 0 doesn't count rediscoveries at all.
+	uint32_t rediscoveryRounds = 50;
+};
+
 //Represents a MAXQP solver that uses a linear relaxation, optionally
 //with constraint learning and semidefiniteness.
 class LPSolver 
@@ -23,21 +164,28 @@ class LPSolver
 	//Current best score achieved, and the solution that does so 
 	//TODO: add option for saving last K good solutions (so that they
 	//can each be used in later branch/bounds, or local search improvements
-	float lowerBound;
+	double lowerBound;
 	VectorXd bestSol;
 	
-	//An upper bound on the score of this problem, as determined through
-	//the exact score of the relaxation
-	float upperBound;
+	//An upper bound on the score of this problem, as certified by the
+	//duals of the relaxation (certifiedBound)
+	double upperBound;
+	
+	//Options it was built with
+	LPSolverConfig config;
+	
+	//Time spent per phase, and counters, by round and in total
+	SolverMetrics metrics;
 	
 	//Constructor: build solver for a given problem
-	LPSolver(Problem* p);
-	//Destructor: mostly for freeing GLPK
-	~LPSolver();
+	LPSolver(Problem* p, const LPSolverConfig& config = LPSolverConfig());
 	
 	//Try to find successively better solutions
 	//TODO: some kind of required bound on goodness?
 	void solve();
+	
+	//Replace the cut removal policy. The solver takes ownership.
+	void setRemovalPolicy(RemovalPolicy* policy);
 
   protected:
 	//Convenience copy from Problem
@@ -47,49 +195,113 @@ class LPSolver
 	//i.e. nQP-choose-2
 	uint32_t nLP;
 	
-	//GLPK linear problem 
-	glp_prob *lp;
-	//Solution config
-#ifdef USE_INTERIOR
-	glp_iptcp parm;
-#else
-	glp_smcp parm;
-#endif
+	//The linear program, in whichever engine config.lpEngine picked
+	std::unique_ptr<LPBackend> lp;
+	//Simplex or interior point, if config.switchLPMethod and lp can do both
+	bool switching;
+	LPMethodSwitch methodSwitch;
+	//Rows added or removed since the last solve
+	uint32_t churn;
+	//config.earlyTermination: times the LP limits have been doubled and
+	//tightened since they were last loose, whether the last solve was cut
+	//short, and whether the next must run in full
+	uint32_t tightenings;
+	bool stoppedEarly;
+	bool solveInFull;
 	
 	//Clauses generated so far (and possibly later removed)
 	std::vector<constraint> active_clauses;
 	std::vector<constraint> inactive_clauses;
 	
 	//Last solution to the linear program
-	std::vector<float> currSol;
+	std::vector<double> currSol;
+	//The same as a full symmetric matrix, with unit diagonal
+	MatrixXd solMat;
+	//And rounded to ScreenReal, for the core search
+	ScreenWorkspace::Matrix solMatScreen;
+	
+	//Scratch matrices for the core search and for findConstraint
+	Workspace workspace;
+	ScreenWorkspace screenWorkspace;
+	
+	//What we know about each row of the LP, in order, and the signatures of
+	//the rows removed in the last config.rediscoveryRounds rounds, with the
+	//round each went in, to count cuts that get rediscovered
+	std::vector<RowInfo> rowInfo;
+	std::unordered_map<uint64_t,uint32_t> removedSignatures;
+	//The rows in the LP, so that a cut found by more than one separator
+	//goes in once
+	std::unordered_set<CanonicalRow, CanonicalRowHash> activeRows;
+	
+	std::unique_ptr<RemovalPolicy> removal;
+	std::vector<uint32_t> rowsToRemove;
 	
-  private:
+	//Scratch for reading rows back out of the LP, and the objective plus
+	//dual-weighted rows, per column
+	std::vector<int> rowIndices;
+	std::vector<double> rowValues, boundCoef;
 	
-	//Given a variable vi and vj, get the index of vij
-	uint32_t getLPVar(uint32_t x, uint32_t y);
+	//LP column of each pair of QP variables
+	PairIndex pairs;
 	
-	//given vij, find i and j
-	std::pair<uint32_t,uint32_t> getQPVars(uint32_t v);
+	//Pairs with a nonzero coefficient in the problem
+	Graph support;
 	
-	//Find a minimal submatrix with at least one negative eigenvalue
-	std::vector<uint32_t>& nonPSDcore(std::vector<uint32_t>& banned);
+	//Source of all randomness in the solve, seeded from config.seed
+	Rng rng;
 	
-	//Given an LP solution vector, extract a submatrix. Allocates a new matrix
-	//for this purpose, must later be freed
-	MatrixXd& getSubmatrix(std::vector<uint32_t> rows);
+	//The kernels below are protected, not private, so that a subclass (as in
+	//microbench.cpp) can drive them on a fixed LP solution
 	
-	//Get the whole matrix for the solution. Equivalent to 
-	//getSubmatrix(range(0,nQP))
-	MatrixXd& getMatrix();
+	//Find a minimal submatrix with at least one negative eigenvalue,
+	//written to 'core' (empty if there is none)
+	void nonPSDcore(const std::vector<uint32_t>& banned, std::vector<uint32_t>& core);
+	template<typename Real>
+	void nonPSDcoreIn(const std::vector<uint32_t>& banned, std::vector<uint32_t>& core);
+	
+	//Whether the submatrix on 'rows' is PSD, up to tolerance, in double
+	bool isPSD(const std::vector<uint32_t>& rows);
+	//The same in the precision Real, from the matching copy of the solution
+	template<typename Real>
+	bool isPSDIn(const std::vector<uint32_t>& rows);
+	
+	//Extract the submatrix on 'rows' of the LP solution into 'result',
+	//which must already be rows.size() square
+	void getSubmatrix(const std::vector<uint32_t>& rows, MatrixXd& result);
+	
+	//Copy currSol into solMat, after each LP solve
+	void cacheSolution();
 	
 	//Given an LP solution stored in currSol, try rounding off
-	//to a QP assignment
+	//to a QP assignment, keeping the best in bestSol and lowerBound
 	void roundToSol();
 	
-	float scoreRelaxation();
+	double scoreRelaxation();
+	
+	//An upper bound on the LP, and so on the problem, from the row duals
+	//of the last solve and the column bounds alone. Valid however far the
+	//solve was from optimal.
+	double certifiedBound();
+	
+	//Add the row sum[ values[i]*x[indices[i]] ] >= rightSide to the LP,
+	//unless it is already there. Returns whether it was added.
+	//1-indexed arrays, as in glp_set_mat_row
+	bool addConstraint(uint32_t len, const int* indices, const double* values, double rightSide);
+	
+	//Remove rows (0-indexed, any order) from the LP in one call
+	void deleteRows(std::vector<uint32_t>& rows);
+	
+	//Refresh slack, dual and age of every row from the last LP solution
+	void updateRowInfo();
 	
 	//Defined in find_constraint.cpp
-	std::vector<double>& findConstraint(MatrixXd& subMat);
+	bool findConstraint(const MatrixXd& subMat, std::vector<double>& constraint);
+	
+	//Defined in separate_hypermetric.cpp
+	uint32_t separateHypermetric();
+	
+	//Defined in separate_odd_cycle.cpp
+	uint32_t separateOddCycles();
 };
 
 //TODO findConstraint, main solving loop
\ No newline at end of file
@@ -0,0 +1,76 @@
+#include "Metrics.hpp"
+
+SolverMetrics::SolverMetrics() : rounds(0), start(std::chrono::steady_clock::now()) {
+	for(int p=0;p<NUM_PHASES;p++) roundTime[p] = totalTime[p] = 0;
+	for(int c=0;c<NUM_COUNTERS;c++) roundCount[c] = totalCount[c] = 0;
+}
+
+const char* SolverMetrics::phaseName(Phase p){
+	switch(p){
+		case PHASE_LP_SOLVE: return "lp_solve";
+		case PHASE_ROW_DELETION: return "row_deletion";
+		case PHASE_CORE_SEARCH: return "core_search";
+		case PHASE_CONSTRAINT_GEN: return "constraint_gen";
+		case PHASE_ROUNDING: return "rounding";
+		default: return "unknown";
+	}
+}
+
+const char* SolverMetrics::counterName(Counter c){
+	switch(c){
+		case COUNT_CUTS_ADDED: return "cuts_added";
+		case COUNT_CUTS_REMOVED: return "cuts_removed";
+		case COUNT_CUTS_REDISCOVERED: return "cuts_rediscovered";
+		case COUNT_LP_ITERATIONS: return "lp_iterations";
+		case COUNT_EIGEN_SOLVES: return "eigen_solves";
+		case COUNT_SCREEN_REJECTS: return "screen_rejects";
+		case COUNT_INTERIOR_SOLVES: return "interior_solves";
+		case COUNT_LP_EARLY_STOPS: return "lp_early_stops";
+		case COUNT_CORE_MISSES: return "core_misses";
+		default: return "unknown";
+	}
+}
+
+std::string SolverMetrics::roundJSON(double lowerBound, double upperBound, uint32_t rows) const {
+	char buf[256];
+	std::string res;
+	snprintf(buf, sizeof(buf), "{\"round\": %u, \"seconds\": %.6f, \"lower_bound\": %.9g, \"upper_bound\": %.9g, \"rows\": %u", rounds, elapsed(), lowerBound, upperBound, rows);
+	res += buf;
+
+	const char* sections[2] = {"round", "total"};
+	for(int s=0;s<2;s++){
+		const double* times = s == 0 ? roundTime : totalTime;
+		const uint64_t* counts = s == 0 ? roundCount : totalCount;
+
+		res += std::string(", \"") + sections[s] + "_seconds\": {";
+		for(int p=0;p<NUM_PHASES;p++){
+			snprintf(buf, sizeof(buf), "%s\"%s\": %.6f", p ? ", " : "", phaseName((Phase)p), times[p]);
+			res += buf;
+		}
+		res += std::string("}, \"") + sections[s] + "_counts\": {";
+		for(int c=0;c<NUM_COUNTERS;c++){
+			snprintf(buf, sizeof(buf), "%s\"%s\": %llu", c ? ", " : "", counterName((Counter)c), (unsigned long long)counts[c]);
+			res += buf;
+		}
+		res += "}";
+	}
+	res += "}";
+	return res;
+}
+
+void SolverMetrics::endRound(FILE* json, double lowerBound, double upperBound, uint32_t rows){
+	rounds++;
+	history.push_back({elapsed(), lowerBound, upperBound, rows});
+	if(json != NULL){
+		fprintf(json, "%s\n", roundJSON(lowerBound, upperBound, rows).c_str());
+		fflush(json);
+	}
+	for(int p=0;p<NUM_PHASES;p++) roundTime[p] = 0;
+	for(int c=0;c<NUM_COUNTERS;c++) roundCount[c] = 0;
+}
+
+void SolverMetrics::merge(const SolverMetrics& other){
+	for(int p=0;p<NUM_PHASES;p++) totalTime[p] += other.totalTime[p];
+	for(int c=0;c<NUM_COUNTERS;c++) totalCount[c] += other.totalCount[c];
+	rounds += other.rounds;
+}
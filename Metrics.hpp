@@ -0,0 +1,102 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdint.h>
+
+//Phases of a solve round that get timed
+enum Phase {
+	PHASE_LP_SOLVE,        //the LP engine
+	PHASE_ROW_DELETION,    //removing slack cuts
+	PHASE_CORE_SEARCH,     //nonPSDcore
+	PHASE_CONSTRAINT_GEN,  //separators and findConstraint
+	PHASE_ROUNDING,        //roundToSol
+	NUM_PHASES
+};
+
+//Events that get counted
+enum Counter {
+	COUNT_CUTS_ADDED,
+	COUNT_CUTS_REMOVED,
+	COUNT_CUTS_REDISCOVERED, //added again after having been removed
+	COUNT_LP_ITERATIONS,     //simplex iterations, as reported by the engine
+	COUNT_EIGEN_SOLVES,
+	COUNT_SCREEN_REJECTS,    //cores from the float screen that were PSD in double
+	COUNT_INTERIOR_SOLVES,   //LP solves done by interior point
+	COUNT_LP_EARLY_STOPS,    //LP solves cut short by LPSolverConfig::earlyTermination
+	COUNT_CORE_MISSES,       //cores of up to 5 rows with no violated inequality
+	NUM_COUNTERS
+};
+
+//Where a solve stood at the end of one round
+struct RoundRecord {
+	double seconds; //since the metrics (and so the solver) were created
+	double lowerBound;
+	double upperBound;
+	uint32_t rows;
+};
+
+//Per-round and whole-solve timings and counters for one solver
+class SolverMetrics
+{
+ public:
+	//Seconds spent in each phase, this round and in total
+	double roundTime[NUM_PHASES];
+	double totalTime[NUM_PHASES];
+
+	uint64_t roundCount[NUM_COUNTERS];
+	uint64_t totalCount[NUM_COUNTERS];
+
+	//Rounds finished so far, and the bounds after each
+	uint32_t rounds;
+	std::vector<RoundRecord> history;
+	
+	std::chrono::steady_clock::time_point start;
+
+	SolverMetrics();
+	
+	//Seconds since creation
+	double elapsed() const {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	void addTime(Phase p, double seconds){
+		roundTime[p] += seconds;
+		totalTime[p] += seconds;
+	}
+	void count(Counter c, uint64_t n = 1){
+		roundCount[c] += n;
+		totalCount[c] += n;
+	}
+
+	//Close the current round: add it to the history, write it to 'json'
+	//(if not NULL) as one line, then zero the per-round values
+	void endRound(FILE* json, double lowerBound, double upperBound, uint32_t rows);
+
+	//Add another solver's totals and rounds into these
+	void merge(const SolverMetrics& other);
+	
+	//One JSON object describing the current round and the totals so far
+	std::string roundJSON(double lowerBound, double upperBound, uint32_t rows) const;
+
+	static const char* phaseName(Phase p);
+	static const char* counterName(Counter c);
+};
+
+//Times a phase on the monotonic clock, from construction to destruction
+class ScopedTimer
+{
+ public:
+	ScopedTimer(SolverMetrics& m, Phase p) : metrics(m), phase(p), start(std::chrono::steady_clock::now()) {}
+	~ScopedTimer(){
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		metrics.addTime(phase, elapsed.count());
+	}
+
+ private:
+	SolverMetrics& metrics;
+	Phase phase;
+	std::chrono::steady_clock::time_point start;
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <utility>		// std::pair
+#include <stdexcept>
+#include <string>
+#include <math.h>
+
+typedef unsigned int uint32_t;
+
+//Numbers the unordered pairs {x,y}, x != y, of n variables as LP columns
+//1..n(n-1)/2, in the order (1,0), (2,0), (2,1), (3,0), ... Everything is
+//integer table lookups; index() and operator() do no checking, for the
+//hot loops, and checked() throws on bad input.
+class PairIndex
+{
+ public:
+	PairIndex(uint32_t n) : n(n), rowOffset(n+1) {
+		for(uint32_t x=0;x<=n;x++) rowOffset[x] = 1 + x*(x-1ull)/2;
+	}
+
+	//number of pairs, i.e. the highest column
+	uint32_t size() const { return rowOffset[n]-1; }
+
+	//column of (x,y), requires x > y
+	uint32_t index(uint32_t x, uint32_t y) const { return rowOffset[x] + y; }
+
+	//column of {x,y}, either order
+	uint32_t operator()(uint32_t x, uint32_t y) const { return x > y ? rowOffset[x] + y : rowOffset[y] + x; }
+
+	uint32_t checked(uint32_t x, uint32_t y) const {
+		if(x == y || x >= n || y >= n) throw std::runtime_error(std::string("Bad LP: ")+std::to_string(x)+", "+std::to_string(y)+", "+std::to_string(n));
+		return (*this)(x, y);
+	}
+
+	//the pair (x,y), x > y, of column v. The square root only gives a
+	//first guess, which is corrected against the table.
+	std::pair<uint32_t,uint32_t> pair(uint32_t v) const {
+		if(v < 1 || v > size()) throw std::runtime_error(std::string("Bad vQP: ")+std::to_string(v)+", "+std::to_string(size()));
+		uint32_t x = (uint32_t)((1 + sqrt(8.*(v-1) + 1))/2);
+		if(x >= n) x = n-1;
+		while(rowOffset[x] > v) x--;
+		while(x+1 < n && rowOffset[x+1] <= v) x++;
+		return std::pair<uint32_t,uint32_t>(x, v - rowOffset[x]);
+	}
+
+ private:
+	uint32_t n;
+	//column of (x,0)
+	std::vector<uint32_t> rowOffset;
+};
+
+//The same numbering for when only some pairs have columns: pairs get
+//columns 1, 2, ... in the order they're added, looked up by hash.
+class SparsePairIndex
+{
+ public:
+	uint32_t size() const { return pairs.size(); }
+
+	//column of {x,y}, adding one if it doesn't exist yet
+	uint32_t add(uint32_t x, uint32_t y){
+		auto it = columns.emplace(key(x, y), pairs.size()+1);
+		if(it.second) pairs.push_back(x > y ? std::pair<uint32_t,uint32_t>(x,y) : std::pair<uint32_t,uint32_t>(y,x));
+		return it.first->second;
+	}
+
+	//column of {x,y}, or 0 if it has none
+	uint32_t operator()(uint32_t x, uint32_t y) const {
+		auto it = columns.find(key(x, y));
+		return it == columns.end() ? 0 : it->second;
+	}
+
+	//the pair (x,y), x > y, of column v
+	std::pair<uint32_t,uint32_t> pair(uint32_t v) const { return pairs[v-1]; }
+
+ private:
+	static unsigned long long key(uint32_t x, uint32_t y){
+		return x > y ? ((unsigned long long)x << 32) | y : ((unsigned long long)y << 32) | x;
+	}
+	std::unordered_map<unsigned long long, uint32_t> columns;
+	std::vector<std::pair<uint32_t,uint32_t>> pairs;
+};
@@ -0,0 +1,389 @@
+#include "Pdlp.hpp"
+
+#include <math.h>
+#include <algorithm>
+#include <limits>
+
+//Default relative tolerance on the row violation and on the duality gap
+static const double TOLERANCE = 1e-6;
+//Default iterations per solve before giving up with LP_INACCURATE
+static const uint64_t MAX_ITERATIONS = 100000;
+//Iterations between checks for convergence and restarts
+static const uint32_t EVAL_INTERVAL = 64;
+//Equilibration passes before the Pock-Chambolle one
+static const uint32_t RUIZ_PASSES = 10;
+//Restart when the KKT error is below SUFFICIENT of the last restart's; or
+//below NECESSARY and no longer falling; or after ARTIFICIAL of all
+//iterations without one
+static const double RESTART_SUFFICIENT = 0.2;
+static const double RESTART_NECESSARY = 0.8;
+static const double RESTART_ARTIFICIAL = 0.36;
+//Smoothing of the primal weight between restarts
+static const double WEIGHT_SMOOTHING = 0.5;
+//Loops shorter than this aren't worth starting threads for
+static const int PARALLEL_MIN = 10000;
+
+Pdlp::Pdlp() : n(0), m(0), totalIterations(0), iterationLimit(MAX_ITERATIONS), tolerance(TOLERANCE) {
+	rowStart.push_back(0);
+}
+
+bool Pdlp::setLimits(uint64_t maxIterations, double relativeTolerance){
+	iterationLimit = maxIterations ? maxIterations : MAX_ITERATIONS;
+	tolerance = relativeTolerance > 0 ? relativeTolerance : TOLERANCE;
+	return true;
+}
+
+void Pdlp::addColumns(uint32_t k, double lowerBound, double upperBound){
+	objectiveCoef.insert(objectiveCoef.end(), k, 0.);
+	lower.insert(lower.end(), k, lowerBound);
+	upper.insert(upper.end(), k, upperBound);
+	//Start in the middle of the box, or at its finite end
+	double start = 0;
+	if(start < lowerBound) start = lowerBound;
+	if(start > upperBound) start = upperBound;
+	x.insert(x.end(), k, start);
+	n += k;
+}
+
+void Pdlp::setObjective(int col, double coef){
+	objectiveCoef[col-1] = coef;
+}
+
+double Pdlp::objective(int col) const {
+	return objectiveCoef[col-1];
+}
+
+void Pdlp::addRow(uint32_t len, const int* indices, const double* values, double rhs){
+	double act = 0;
+	for(uint32_t k=1;k<=len;k++){
+		if(values[k] == 0) continue;
+		rowCol.push_back(indices[k]-1);
+		rowVal.push_back(values[k]);
+		act += values[k]*x[indices[k]-1];
+	}
+	rowStart.push_back(rowCol.size());
+	rightSide.push_back(rhs);
+	activity.push_back(act);
+	y.push_back(0);
+	m++;
+}
+
+void Pdlp::deleteRows(uint32_t count, const int* rows){
+	if(!count) return;
+	uint32_t r = 0, nz = 0;
+	for(uint32_t i=0, k=1;i<m;i++){
+		if(k <= count && (uint32_t)rows[k]-1 == i){
+			k++;
+			continue;
+		}
+		uint32_t begin = rowStart[i], end = rowStart[i+1];
+		rowStart[r] = nz;
+		for(uint32_t t=begin;t<end;t++){
+			rowCol[nz] = rowCol[t];
+			rowVal[nz++] = rowVal[t];
+		}
+		rightSide[r] = rightSide[i];
+		activity[r] = activity[i];
+		y[r] = y[i];
+		r++;
+	}
+	rowStart[r] = nz;
+	rowStart.resize(r+1);
+	rowCol.resize(nz);
+	rowVal.resize(nz);
+	rightSide.resize(r);
+	activity.resize(r);
+	y.resize(r);
+	m = r;
+}
+
+uint32_t Pdlp::getRow(int row, int* indices, double* values, double& rhs) const {
+	uint32_t len = 0;
+	for(uint32_t t=rowStart[row-1];t<rowStart[row];t++){
+		len++;
+		indices[len] = rowCol[t]+1;
+		values[len] = rowVal[t];
+	}
+	rhs = rightSide[row-1];
+	return len;
+}
+
+double Pdlp::slackAccuracy(int row) const {
+	double size = 1 + fabs(rightSide[row-1]);
+	for(uint32_t t=rowStart[row-1];t<rowStart[row];t++)
+		size += fabs(rowVal[t]);
+	return tolerance*size;
+}
+
+double Pdlp::objectiveValue() const {
+	double value = 0;
+	for(uint32_t j=0;j<n;j++)
+		value += objectiveCoef[j]*x[j];
+	return value;
+}
+
+double Pdlp::buildScaled(){
+	uint32_t nnz = rowCol.size();
+	val = rowVal;
+	rowScale.assign(m, 1.);
+	colScale.assign(n, 1.);
+
+	//Column-wise pattern, with the row-wise entry each slot copies
+	colStart.assign(n+1, 0);
+	for(uint32_t t=0;t<nnz;t++) colStart[rowCol[t]+1]++;
+	for(uint32_t j=0;j<n;j++) colStart[j+1] += colStart[j];
+	colRow.resize(nnz);
+	std::vector<uint32_t> entry(nnz), next(colStart.begin(), colStart.end()-1);
+	for(uint32_t i=0;i<m;i++){
+		for(uint32_t t=rowStart[i];t<rowStart[i+1];t++){
+			uint32_t slot = next[rowCol[t]]++;
+			colRow[slot] = i;
+			entry[slot] = t;
+		}
+	}
+
+	//Ruiz passes scale by the inverse square root of each row's and
+	//column's largest entry; the last, Pock-Chambolle, pass by that of
+	//their absolute sums
+	std::vector<double> rowFactor(m), colFactor(n);
+	for(uint32_t pass=0;pass<=RUIZ_PASSES;pass++){
+		bool sums = pass == RUIZ_PASSES;
+		#pragma omp parallel for schedule(static) if((int)m > PARALLEL_MIN)
+		for(uint32_t i=0;i<m;i++){
+			double size = 0;
+			for(uint32_t t=rowStart[i];t<rowStart[i+1];t++)
+				size = sums ? size + fabs(val[t]) : std::max(size, fabs(val[t]));
+			rowFactor[i] = size > 0 ? 1/sqrt(size) : 1.;
+		}
+		#pragma omp parallel for schedule(static) if((int)n > PARALLEL_MIN)
+		for(uint32_t j=0;j<n;j++){
+			double size = 0;
+			for(uint32_t s=colStart[j];s<colStart[j+1];s++)
+				size = sums ? size + fabs(val[entry[s]]) : std::max(size, fabs(val[entry[s]]));
+			colFactor[j] = size > 0 ? 1/sqrt(size) : 1.;
+		}
+		#pragma omp parallel for schedule(static) if((int)m > PARALLEL_MIN)
+		for(uint32_t i=0;i<m;i++){
+			for(uint32_t t=rowStart[i];t<rowStart[i+1];t++)
+				val[t] *= rowFactor[i]*colFactor[rowCol[t]];
+			rowScale[i] *= rowFactor[i];
+		}
+		for(uint32_t j=0;j<n;j++) colScale[j] *= colFactor[j];
+	}
+
+	colVal.resize(nnz);
+	for(uint32_t s=0;s<nnz;s++) colVal[s] = val[entry[s]];
+
+	cost.resize(n);
+	lo.resize(n);
+	up.resize(n);
+	for(uint32_t j=0;j<n;j++){
+		cost[j] = -objectiveCoef[j]*colScale[j];
+		lo[j] = lower[j]/colScale[j];
+		up[j] = upper[j]/colScale[j];
+	}
+	rhs.resize(m);
+	for(uint32_t i=0;i<m;i++) rhs[i] = rightSide[i]*rowScale[i];
+
+	//||A|| <= sqrt(largest row sum * largest column sum) of |A|
+	double rowMax = 0, colMax = 0;
+	for(uint32_t i=0;i<m;i++){
+		double sum = 0;
+		for(uint32_t t=rowStart[i];t<rowStart[i+1];t++) sum += fabs(val[t]);
+		rowMax = std::max(rowMax, sum);
+	}
+	for(uint32_t j=0;j<n;j++){
+		double sum = 0;
+		for(uint32_t s=colStart[j];s<colStart[j+1];s++) sum += fabs(colVal[s]);
+		colMax = std::max(colMax, sum);
+	}
+	return sqrt(rowMax*colMax);
+}
+
+void Pdlp::computeAty(bool accumulate){
+	#pragma omp parallel for schedule(static) if((int)n > PARALLEL_MIN)
+	for(uint32_t j=0;j<n;j++){
+		double sum = 0;
+		for(uint32_t s=colStart[j];s<colStart[j+1];s++)
+			sum += colVal[s]*ys[colRow[s]];
+		aty[j] = sum;
+		if(accumulate) atySum[j] += sum;
+	}
+}
+
+void Pdlp::step(double tau, double sigma){
+	//Primal step against the gradient c - A^T y, projected onto the box
+	#pragma omp parallel for schedule(static) if((int)n > PARALLEL_MIN)
+	for(uint32_t j=0;j<n;j++){
+		double next = xs[j] - tau*(cost[j] - aty[j]);
+		next = std::min(std::max(next, lo[j]), up[j]);
+		xs[j] = next;
+		xSum[j] += next;
+	}
+
+	//Dual step at the extrapolated point 2 x' - x, whose product is 2 A x' - A x
+	#pragma omp parallel for schedule(static) if((int)m > PARALLEL_MIN)
+	for(uint32_t i=0;i<m;i++){
+		double product = 0;
+		for(uint32_t t=rowStart[i];t<rowStart[i+1];t++)
+			product += val[t]*xs[rowCol[t]];
+		double next = ys[i] + sigma*(rhs[i] - (2*product - ax[i]));
+		next = std::max(next, 0.);
+		ax[i] = product;
+		axSum[i] += product;
+		ys[i] = next;
+		ySum[i] += next;
+	}
+
+	computeAty(true);
+}
+
+Pdlp::Quality Pdlp::evaluate(const std::vector<double>& px, const std::vector<double>& py,
+	const std::vector<double>& pax, const std::vector<double>& paty, double weight) const {
+	double scaled2 = 0, unscaled2 = 0, rowTerm = 0;
+	#pragma omp parallel for schedule(static) reduction(+:scaled2,unscaled2,rowTerm) if((int)m > PARALLEL_MIN)
+	for(uint32_t i=0;i<m;i++){
+		double violation = std::max(rhs[i] - weight*pax[i], 0.);
+		scaled2 += violation*violation;
+		violation /= rowScale[i];
+		unscaled2 += violation*violation;
+		rowTerm += rhs[i]*weight*py[i];
+	}
+	//The dual objective takes each reduced cost at its best bound, so it
+	//is a bound for any y >= 0
+	double primal = 0, boxTerm = 0;
+	#pragma omp parallel for schedule(static) reduction(+:primal,boxTerm) if((int)n > PARALLEL_MIN)
+	for(uint32_t j=0;j<n;j++){
+		primal += cost[j]*weight*px[j];
+		double reduced = cost[j] - weight*paty[j];
+		boxTerm += reduced > 0 ? reduced*lo[j] : reduced*up[j];
+	}
+	Quality q = {sqrt(unscaled2), sqrt(scaled2), primal, rowTerm + boxTerm};
+	return q;
+}
+
+//Error of a point in the restart criteria
+static double kktError(double scaledResidual, double gap, double primalWeight){
+	return sqrt(primalWeight*primalWeight*scaledResidual*scaledResidual + gap*gap);
+}
+
+static double distance(const std::vector<double>& a, const std::vector<double>& b){
+	double sum = 0;
+	for(uint32_t i=0;i<a.size();i++) sum += (a[i]-b[i])*(a[i]-b[i]);
+	return sqrt(sum);
+}
+
+LPStatus Pdlp::solve(){
+	double normA = buildScaled();
+	double eta = normA > 0 ? 0.99/normA : 1.;
+
+	//Warm start from the last solution, with new rows at y = 0
+	xs.resize(n);
+	for(uint32_t j=0;j<n;j++)
+		xs[j] = std::min(std::max(x[j]/colScale[j], lo[j]), up[j]);
+	ys.resize(m);
+	for(uint32_t i=0;i<m;i++)
+		ys[i] = std::max(y[i], 0.)/rowScale[i];
+	ax.resize(m);
+	#pragma omp parallel for schedule(static) if((int)m > PARALLEL_MIN)
+	for(uint32_t i=0;i<m;i++){
+		double product = 0;
+		for(uint32_t t=rowStart[i];t<rowStart[i+1];t++)
+			product += val[t]*xs[rowCol[t]];
+		ax[i] = product;
+	}
+	aty.resize(n);
+	computeAty(false);
+
+	double bNorm = 0, cNorm = 0;
+	for(uint32_t i=0;i<m;i++) bNorm += rhs[i]*rhs[i];
+	for(uint32_t j=0;j<n;j++) cNorm += cost[j]*cost[j];
+	double primalWeight = bNorm > 0 && cNorm > 0 ? sqrt(cNorm/bNorm) : 1.;
+	double rightNorm = 0;
+	for(uint32_t i=0;i<m;i++) rightNorm += rightSide[i]*rightSide[i];
+	rightNorm = sqrt(rightNorm);
+	auto converged = [&](const Quality& q){
+		double gap = fabs(q.primalObjective - q.dualObjective);
+		return q.primalResidual <= tolerance*(1 + rightNorm)
+			&& gap <= tolerance*(1 + fabs(q.primalObjective) + fabs(q.dualObjective));
+	};
+
+	xSum.assign(n, 0.);
+	ySum.assign(m, 0.);
+	axSum.assign(m, 0.);
+	atySum.assign(n, 0.);
+	xRestart = xs;
+	yRestart = ys;
+	Quality q = evaluate(xs, ys, ax, aty, 1.);
+	bool done = converged(q);
+	double restartError = kktError(q.scaledResidual, q.primalObjective - q.dualObjective, primalWeight);
+	double lastError = std::numeric_limits<double>::infinity();
+
+	uint32_t sinceRestart = 0;
+	for(uint64_t it=1;!done && it<=iterationLimit;it++){
+		step(eta/primalWeight, eta*primalWeight);
+		sinceRestart++;
+		totalIterations++;
+		if(sinceRestart % EVAL_INTERVAL != 0 && it != iterationLimit)
+			continue;
+
+		//The better of the current point and the average since the restart
+		Quality current = evaluate(xs, ys, ax, aty, 1.);
+		Quality average = evaluate(xSum, ySum, axSum, atySum, 1./sinceRestart);
+		double currentError = kktError(current.scaledResidual, current.primalObjective - current.dualObjective, primalWeight);
+		double averageError = kktError(average.scaledResidual, average.primalObjective - average.dualObjective, primalWeight);
+		bool useAverage = averageError < currentError;
+		double error = useAverage ? averageError : currentError;
+		q = useAverage ? average : current;
+		done = converged(q);
+
+		bool restart = error <= RESTART_SUFFICIENT*restartError
+			|| (error <= RESTART_NECESSARY*restartError && error > lastError)
+			|| sinceRestart >= RESTART_ARTIFICIAL*it;
+		if(!done && !restart && it != iterationLimit){
+			lastError = error;
+			continue;
+		}
+
+		if(useAverage){
+			double scale = 1./sinceRestart;
+			for(uint32_t j=0;j<n;j++){
+				xs[j] = xSum[j]*scale;
+				aty[j] = atySum[j]*scale;
+			}
+			for(uint32_t i=0;i<m;i++){
+				ys[i] = ySum[i]*scale;
+				ax[i] = axSum[i]*scale;
+			}
+		}
+		if(done || it == iterationLimit)
+			break;
+
+		//Rebalance the steps by how far each side moved since the last restart
+		double primalMove = distance(xs, xRestart), dualMove = distance(ys, yRestart);
+		if(primalMove > 1e-10 && dualMove > 1e-10)
+			primalWeight = exp(WEIGHT_SMOOTHING*log(dualMove/primalMove) + (1-WEIGHT_SMOOTHING)*log(primalWeight));
+		xRestart = xs;
+		yRestart = ys;
+		std::fill(xSum.begin(), xSum.end(), 0.);
+		std::fill(ySum.begin(), ySum.end(), 0.);
+		std::fill(axSum.begin(), axSum.end(), 0.);
+		std::fill(atySum.begin(), atySum.end(), 0.);
+		sinceRestart = 0;
+		restartError = kktError(q.scaledResidual, q.primalObjective - q.dualObjective, primalWeight);
+		lastError = std::numeric_limits<double>::infinity();
+	}
+
+	//Back to the original problem
+	for(uint32_t j=0;j<n;j++)
+		x[j] = std::min(std::max(xs[j]*colScale[j], lower[j]), upper[j]);
+	#pragma omp parallel for schedule(static) if((int)m > PARALLEL_MIN)
+	for(uint32_t i=0;i<m;i++){
+		y[i] = ys[i]*rowScale[i];
+		double act = 0;
+		for(uint32_t t=rowStart[i];t<rowStart[i+1];t++)
+			act += rowVal[t]*x[rowCol[t]];
+		activity[i] = act;
+	}
+	return done ? LP_OPTIMAL : LP_INACCURATE;
+}
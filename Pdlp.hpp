@@ -0,0 +1,101 @@
+#pragma once
+
+#include "LPBackend.hpp"
+
+#include <vector>
+
+//LPBackend for LPs too large to factor: a first-order primal-dual hybrid
+//gradient method in the style of PDLP. It only touches the matrix through
+//products A x and A^T y, which run over the rows and over the columns in
+//parallel (OpenMP), so the cost of an iteration is linear in the nonzeros.
+// * Rows and columns are equilibrated (Ruiz, then Pock-Chambolle) before
+//   each solve, which also bounds ||A|| by 1 and so fixes the step size.
+// * Iterates are averaged, and the method restarts from the average or
+//   the current point whenever that has cut the KKT error enough; the
+//   primal weight (ratio of the primal and dual steps) is rebalanced at
+//   each restart.
+// * As every column is boxed, any dual vector gives a valid bound once the
+//   reduced costs are put on their best bounds. That bound closing on the
+//   primal objective, with the rows satisfied, is the stopping test.
+// * Solutions are approximate, to a relative tolerance, and there is no
+//   basis. Adding and removing rows keeps the primal point and the duals
+//   of the other rows, so the next solve is warm-started.
+class Pdlp : public LPBackend
+{
+ public:
+	Pdlp();
+
+	const char* name() const { return "pdlp"; }
+
+	void addColumns(uint32_t n, double lower, double upper);
+	void setObjective(int col, double coef);
+	double objective(int col) const;
+
+	void addRow(uint32_t len, const int* indices, const double* values, double rightSide);
+	void deleteRows(uint32_t count, const int* rows);
+	uint32_t numRows() const { return m; }
+	uint32_t getRow(int row, int* indices, double* values, double& rightSide) const;
+
+	//LP_INACCURATE if the iteration limit came first, with the best point seen
+	LPStatus solve();
+	uint64_t iterations() const { return totalIterations; }
+	bool setLimits(uint64_t maxIterations, double relativeTolerance);
+
+	double objectiveValue() const;
+	double colPrimal(int col) const { return x[col-1]; }
+	double rowSlack(int row) const { return activity[row-1] - rightSide[row-1]; }
+	double rowDual(int row) const { return -y[row-1]; }
+	//The tolerance, relative to the row's right side and coefficients
+	double slackAccuracy(int row) const;
+	BasisStatus rowStatus(int) const { return BASIS_UNKNOWN; }
+	BasisStatus colStatus(int) const { return BASIS_UNKNOWN; }
+
+ private:
+	uint32_t n, m;
+	std::vector<double> objectiveCoef, lower, upper;
+	//Rows one after another: row i is rowCol/rowVal[rowStart[i]..rowStart[i+1])
+	std::vector<uint32_t> rowStart;
+	std::vector<int> rowCol;
+	std::vector<double> rowVal, rightSide;
+
+	//The last solution: primal point, row activities and row multipliers
+	//(>= 0, of the rows in the minimization form)
+	std::vector<double> x, activity, y;
+	uint64_t totalIterations;
+	//Of each solve, as set by setLimits
+	uint64_t iterationLimit;
+	double tolerance;
+
+	//The scaled problem of the current solve. Scaled x is x / colScale,
+	//scaled y is y / rowScale.
+	std::vector<double> colScale, rowScale;
+	std::vector<double> cost, lo, up, rhs;
+	std::vector<double> val;
+	std::vector<uint32_t> colStart;
+	std::vector<int> colRow;
+	std::vector<double> colVal;
+
+	//Scaled iterates: current point with its A x and A^T y, running sums
+	//for the average, and the point of the last restart
+	std::vector<double> xs, ys, ax, aty;
+	std::vector<double> xSum, ySum, axSum, atySum;
+	std::vector<double> xRestart, yRestart;
+
+	struct Quality {
+		double primalResidual; //||max(0, b - A x)||, unscaled
+		double scaledResidual; //the same in the scaled problem
+		double primalObjective, dualObjective; //of the minimization
+	};
+
+	//Scale the rows and columns and build the column-wise copy; returns a
+	//bound on the norm of the scaled matrix
+	double buildScaled();
+	//Quality of the point (px, py) with products pax = A px, paty = A^T py,
+	//each multiplied by 'weight'
+	Quality evaluate(const std::vector<double>& px, const std::vector<double>& py,
+		const std::vector<double>& pax, const std::vector<double>& paty, double weight) const;
+	//One iteration from xs, ys with primal step tau and dual step sigma
+	void step(double tau, double sigma);
+	//aty = A^T ys, also added to atySum if accumulating
+	void computeAty(bool accumulate);
+};
@@ -0,0 +1,276 @@
+#include "Presolve.hpp"
+
+#include <cmath>
+#include <limits>
+#include <queue>
+
+//Dinic's max flow on a network given as a list of arcs. Arc r is stored
+//as residual arcs 2r (forward) and 2r+1 (backward).
+class MaxFlow
+{
+ public:
+	MaxFlow(uint32_t nodes, double eps) : first(nodes, -1), level(nodes), next(nodes), eps(eps) {}
+
+	uint32_t addArc(uint32_t from, uint32_t to, double cap){
+		uint32_t r = this->from.size();
+		this->from.push_back(from);
+		this->to.push_back(to);
+		this->cap.push_back(cap);
+		flow.push_back(0);
+		for(int dir=0;dir<2;dir++){
+			link.push_back(first[dir ? to : from]);
+			first[dir ? to : from] = 2*r+dir;
+		}
+		return r;
+	}
+
+	double run(uint32_t s, uint32_t t){
+		double total = 0;
+		while(buildLevels(s, t)){
+			for(uint32_t v=0;v<first.size();v++) next[v] = first[v];
+			double pushed;
+			while((pushed = augment(s, t, std::numeric_limits<double>::infinity())) > 0)
+				total += pushed;
+		}
+		return total;
+	}
+
+	double residual(uint32_t e) const {
+		uint32_t r = e/2;
+		return e%2 ? flow[r] : cap[r] - flow[r];
+	}
+	uint32_t head(uint32_t e) const {
+		return e%2 ? from[e/2] : to[e/2];
+	}
+
+	std::vector<uint32_t> from, to;
+	std::vector<double> cap, flow;
+	std::vector<int> first, link;
+
+ private:
+	bool buildLevels(uint32_t s, uint32_t t){
+		std::fill(level.begin(), level.end(), -1);
+		std::queue<uint32_t> q;
+		level[s] = 0;
+		q.push(s);
+		while(!q.empty()){
+			uint32_t v = q.front();
+			q.pop();
+			for(int e=first[v];e>=0;e=link[e]){
+				uint32_t w = head(e);
+				if(level[w] < 0 && residual(e) > eps){
+					level[w] = level[v]+1;
+					q.push(w);
+				}
+			}
+		}
+		return level[t] >= 0;
+	}
+
+	double augment(uint32_t v, uint32_t t, double limit){
+		if(v == t) return limit;
+		for(int& e=next[v];e>=0;e=link[e]){
+			uint32_t w = head(e);
+			double res = residual(e);
+			if(level[w] != level[v]+1 || res <= eps) continue;
+			double pushed = augment(w, t, std::min(limit, res));
+			if(pushed > 0){
+				flow[e/2] += e%2 ? -pushed : pushed;
+				return pushed;
+			}
+		}
+		return 0;
+	}
+
+	std::vector<int> level, next;
+	double eps;
+};
+
+//Literal nodes of the implication network: x_i = +1 and x_i = -1.
+//Variable 0 is "true", so pos(0) is the source and neg(0) the sink.
+static uint32_t pos(uint32_t i){ return 2*i; }
+static uint32_t neg(uint32_t i){ return 2*i+1; }
+
+Presolve::Presolve(const Problem& p, const PresolveConfig& config) : reduced(NULL), fixedByDominance(0), fixedByRoofDuality(0), original(p) {
+	uint32_t n = p.nQP;
+	mapping.assign(n, -1);
+	fixedValue.assign(n, 0);
+	linear.assign(n, 0);
+	for(uint32_t j=1;j<n;j++) linear[j] = p.coeffs.coeff(0, j);
+	quadratic = p.coeffs.selfadjointView<Eigen::Upper>();
+	constant = p.constantTerm;
+	roofBound = std::numeric_limits<double>::infinity();
+
+	bool changed = true;
+	while(changed){
+		changed = false;
+		if(config.dominance) changed |= fixByDominance();
+		if(config.roofDuality) changed |= fixByRoofDuality();
+	}
+
+	//Build the problem on what's left
+	std::vector<uint32_t> freeVars;
+	for(uint32_t i=0;i<n;i++){
+		if(fixedValue[i] == 0){
+			mapping[i] = freeVars.size();
+			freeVars.push_back(i);
+		}
+	}
+	uint32_t m = freeVars.size();
+	reduced = new Problem(m);
+	reduced->constantTerm = constant;
+	double sumAbs = constant;
+	std::vector<Eigen::Triplet<double>> terms;
+	for(uint32_t b=1;b<m;b++){
+		terms.push_back({0, (int)b, linear[freeVars[b]]});
+		sumAbs += fabs(linear[freeVars[b]]);
+		for(SparseMatrix<double>::InnerIterator it(quadratic, freeVars[b]);it;++it){
+			uint32_t i = it.row();
+			if(i == 0 || i >= freeVars[b] || fixedValue[i] != 0) continue;
+			terms.push_back({mapping[i], (int)b, it.value()});
+			sumAbs += fabs(it.value());
+		}
+	}
+	reduced->coeffs.setFromTriplets(terms.begin(), terms.end());
+	roofBound = std::min(roofBound, sumAbs);
+}
+
+Presolve::~Presolve(){
+	delete &reduced->coeffs;
+	delete reduced;
+}
+
+//Fix x_j, folding its terms into the linear terms of the free variables
+//and the constant
+void Presolve::fix(uint32_t j, int value){
+	fixedValue[j] = value;
+	constant += linear[j]*value;
+	for(SparseMatrix<double>::InnerIterator it(quadratic, j);it;++it){
+		uint32_t k = it.row();
+		if(k != 0 && fixedValue[k] == 0)
+			linear[k] += it.value()*value;
+	}
+}
+
+bool Presolve::fixByDominance(){
+	uint32_t n = original.nQP;
+	bool any = false;
+
+	//Fixing a variable only changes its neighbours, so recheck just those
+	std::vector<uint32_t> work;
+	std::vector<bool> queued(n, true);
+	for(uint32_t j=n;j-->1;)
+		if(fixedValue[j] == 0) work.push_back(j);
+		else queued[j] = false;
+
+	while(!work.empty()){
+		uint32_t j = work.back();
+		work.pop_back();
+		queued[j] = false;
+		if(fixedValue[j] != 0) continue;
+
+		double rowSum = 0;
+		for(SparseMatrix<double>::InnerIterator it(quadratic, j);it;++it)
+			if(it.row() != 0 && fixedValue[it.row()] == 0) rowSum += fabs(it.value());
+		if(fabs(linear[j]) < rowSum) continue;
+
+		fix(j, linear[j] >= 0 ? 1 : -1);
+		fixedByDominance++;
+		any = true;
+		for(SparseMatrix<double>::InnerIterator it(quadratic, j);it;++it){
+			uint32_t k = it.row();
+			if(k != 0 && fixedValue[k] == 0 && !queued[k] && it.value() != 0){
+				queued[k] = true;
+				work.push_back(k);
+			}
+		}
+	}
+	return any;
+}
+
+bool Presolve::fixByRoofDuality(){
+	uint32_t n = original.nQP;
+
+	//Each term Q x_i x_j (with x_0 = 1 carrying the linear terms) costs
+	//-|Q| at best, and 2|Q| more when its two literals disagree with the
+	//sign of Q: for Q > 0 when x_i != x_j, for Q < 0 when x_i == x_j.
+	//"a true and b false costs w" becomes arcs a->b and ~b->~a of w/2, so
+	//a consistent cut (true literals on the source side) costs exactly the
+	//penalties, and the min cut bounds them from below.
+	double maxCoeff = 0, sumAbs = 0;
+	std::vector<std::pair<std::pair<uint32_t,uint32_t>,double>> terms;
+	for(uint32_t j=1;j<n;j++){
+		if(fixedValue[j] != 0) continue;
+		if(linear[j] != 0) terms.push_back({{0, j}, linear[j]});
+		for(SparseMatrix<double>::InnerIterator it(quadratic, j);it;++it){
+			uint32_t i = it.row();
+			if(i != 0 && i < j && fixedValue[i] == 0 && it.value() != 0) terms.push_back({{i, j}, it.value()});
+		}
+	}
+	for(auto& t : terms){
+		maxCoeff = std::max(maxCoeff, fabs(t.second));
+		sumAbs += fabs(t.second);
+	}
+
+	MaxFlow net(2*n, 1e-9*std::max(1.0, maxCoeff));
+	auto addPenalty = [&](uint32_t a, uint32_t b, double w){
+		net.addArc(a, b, w/2);
+		net.addArc(b^1, a^1, w/2); //its mirror, at the next index
+	};
+	for(auto& t : terms){
+		uint32_t i = t.first.first, j = t.first.second;
+		double w = 2*fabs(t.second);
+		if(t.second > 0){
+			addPenalty(pos(i), pos(j), w);
+			addPenalty(pos(j), pos(i), w);
+		} else {
+			addPenalty(pos(i), neg(j), w);
+			addPenalty(neg(i), pos(j), w);
+		}
+	}
+
+	double flow = net.run(pos(0), neg(0));
+	roofBound = std::min(roofBound, constant + sumAbs - flow);
+
+	//Symmetrize: average each arc's flow with its mirror's. Still a max
+	//flow, and now its residual graph is symmetric too, so no literal and
+	//its negation are both reachable from the source.
+	std::vector<double> sym(net.flow.size());
+	for(uint32_t r=0;r<net.flow.size();r++)
+		sym[r] = (net.flow[r] + net.flow[r^1])/2;
+	net.flow = sym;
+
+	std::vector<bool> reached(2*n, false);
+	std::vector<uint32_t> stack(1, pos(0));
+	reached[pos(0)] = true;
+	double eps = 1e-9*std::max(1.0, maxCoeff);
+	while(!stack.empty()){
+		uint32_t v = stack.back();
+		stack.pop_back();
+		for(int e=net.first[v];e>=0;e=net.link[e]){
+			uint32_t w = net.head(e);
+			if(!reached[w] && net.residual(e) > eps){
+				reached[w] = true;
+				stack.push_back(w);
+			}
+		}
+	}
+
+	bool any = false;
+	for(uint32_t j=1;j<n;j++){
+		if(fixedValue[j] != 0 || reached[pos(j)] == reached[neg(j)]) continue;
+		fix(j, reached[pos(j)] ? 1 : -1);
+		fixedByRoofDuality++;
+		any = true;
+	}
+	return any;
+}
+
+VectorXd Presolve::expand(const VectorXd& reducedSol) const {
+	//the fixings assume x_0 = +1, so flip the reduced solution to match
+	double s = reducedSol(0) >= 0 ? 1 : -1;
+	VectorXd res(original.nQP);
+	for(uint32_t i=0;i<original.nQP;i++)
+		res(i) = fixedValue[i] != 0 ? fixedValue[i] : s*reducedSol(mapping[i]);
+	return res;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Problem.hpp"
+
+#include <vector>
+
+struct PresolveConfig {
+	//Fix x_j = sign(l_j) when its linear term outweighs all its quadratic ones
+	bool dominance = true;
+	//Fix the variables roof duality proves (strong persistencies)
+	bool roofDuality = true;
+};
+
+//Fixes variables whose optimal value can be proven cheaply, and builds the
+//smaller problem on the rest. Variable 0 is taken to be "true" (+1), as in
+//the SAT reductions; this is no loss since flipping every variable keeps
+//the score. Two rules are applied until neither fixes anything more:
+//
+// * Dominance: with x_0 = 1, x_j's part of the objective is
+//   x_j (l_j + sum_k Q_jk x_k), with l_j = Q_0j. If |l_j| >= sum_k |Q_jk|,
+//   some optimum has x_j = sign(l_j).
+//
+// * Roof duality: the implication network of the problem (two nodes per
+//   variable, one per literal) has a symmetric maximum flow whose residual
+//   graph proves every literal reachable from "true" holds in all optima.
+//   The flow value also bounds the optimum from above.
+//
+//Fixed variables fold into the linear terms and constant of the rest, so
+//reduced->score(y) == original.score(expand(y)).
+class Presolve
+{
+ public:
+	Presolve(const Problem& p, const PresolveConfig& config = PresolveConfig());
+	~Presolve();
+	//It owns 'reduced', so a copy would free it twice
+	Presolve(const Presolve&) = delete;
+	Presolve& operator=(const Presolve&) = delete;
+
+	//The problem on the free variables. Variable 0 stays variable 0.
+	Problem* reduced;
+
+	//For each original variable, its variable in 'reduced', or -1 if fixed
+	std::vector<int> mapping;
+	//For each original variable, the value it was fixed to (+1/-1), or 0 if free
+	std::vector<int> fixedValue;
+
+	uint32_t fixedByDominance;
+	uint32_t fixedByRoofDuality;
+
+	//Upper bound on the optimum from the last roof dual solved (the
+	//sum of |coefficients| bound if roof duality is off)
+	double roofBound;
+
+	uint32_t numFixed() const { return fixedByDominance + fixedByRoofDuality; }
+
+	//Map an assignment of the reduced problem back to the original one
+	VectorXd expand(const VectorXd& reducedSol) const;
+
+ private:
+	const Problem& original;
+
+	//The quadratic terms of the original both ways round (Q + Q^T), so
+	//that column j lists every term of x_j
+	SparseMatrix<double> quadratic;
+	//Current problem state while presolving, with x_0 = +1: linear term of
+	//each variable (folded-in fixings included), and constant
+	std::vector<double> linear;
+	double constant;
+
+	bool fixByDominance();
+	bool fixByRoofDuality();
+	void fix(uint32_t j, int value);
+};
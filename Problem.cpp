@@ -1,162 +1,166 @@
 #include "Problem.hpp"
 
 #include <iostream>
+#include <stdexcept>
+#include <string>
 
-Problem::Problem(uint32_t n) : nQP(n), coeffs(*new MatrixXd(n,n)), constantTerm(0) {coeffs.setZero();}
+Problem::Problem(uint32_t n) : nQP(n), coeffs(*new SparseMatrix<double>(n,n)), constantTerm(0) {}
 
-Problem::Problem(uint32_t n, MatrixXd& coeff, float cT) : nQP(n), coeffs(coeff), constantTerm(cT) {}
+Problem::Problem(uint32_t n, SparseMatrix<double>& coeff, double cT) : nQP(n), coeffs(coeff), constantTerm(cT) {}
 
-Problem* Problem::from2SAT(uint32_t n, std::vector<clause2>& clauses, std::vector<float>& literalWeights){
+//Terms are gathered as (i, j, coefficient) and summed into coeffs at the
+//end, so each builder is linear in the size of its input
+typedef std::vector<Eigen::Triplet<double>> Terms;
+
+//x with weight w corresponds to w/2 + (w/2)x; ~x to w/2 - (w/2)x.
+static void addLiteral(Problem* res, Terms& terms, double w, int xL){
+	terms.push_back({0, abs(xL), (w/2)*(xL > 0 ? 1 : -1)});
+	res->constantTerm += w/2;
+}
+
+// (x OR y) with weight w on {-1,+1}
+//corresponds to (w/4)x + (w/4)y - (w/4)xy + 3/4w.
+//Negating a variable means negating appropriate term.
+static void addClause2(Problem* res, Terms& terms, double w, int xL, int yL){
+	int xV = abs(xL), yV = abs(yL);
+	terms.push_back({0, xV, (w/4)*(xL > 0 ? 1 : -1)});
+	terms.push_back({0, yV, (w/4)*(yL > 0 ? 1 : -1)});
+	terms.push_back({std::min(xV,yV), std::max(xV,yV), -(w/4)*(xL > 0 ? 1 : -1)*(yL > 0 ? 1 : -1)});
+	res->constantTerm += 0.75*w;
+}
+
+Problem* Problem::from2SAT(uint32_t n, const std::vector<clause2>& clauses, const std::vector<double>& literalWeights){
 	uint32_t nQP = n+1;
 	
 	Problem* res = new Problem(nQP);
+	Terms terms;
 	
-	for(uint32_t i=1;i<nQP;i++){
-		//x with weight w corresponds to w/2 + (w/2)x
-		float w = literalWeights[i-1];
-		res->coeffs(0, i) = w/2.;
-		res->constantTerm += w/2.;
-	}
-	for(uint32_t c=0;c<clauses.size();c++){
-		// (x OR y) with weight w on {-1,+1}
-		//corresponds to (w/4)x + (w/4)y - (w/4)xy + 3/4w.
-		//Negating a variable means negating appropriate term.
-		float w = std::get<0>(clauses[c]);
-		int xL = std::get<1>(clauses[c]);
-		int yL = std::get<2>(clauses[c]);
-		int xV = abs(xL), yV = abs(yL);
-		res->coeffs(0, xV) += (w/4)*(xL > 0 ? 1 : -1);
-		res->coeffs(0, yV) += (w/4)*(yL > 0 ? 1 : -1);
-		res->coeffs(std::min(xV,yV), std::max(xV,yV)) += -(w/4)*(xL > 0 ? 1 : -1)*(yL > 0 ? 1 : -1);
-		res->constantTerm += 0.75*w;
-	}
+	for(uint32_t i=1;i<nQP;i++)
+		addLiteral(res, terms, literalWeights[i-1], i);
+	for(uint32_t c=0;c<clauses.size();c++)
+		addClause2(res, terms, std::get<0>(clauses[c]), std::get<1>(clauses[c]), std::get<2>(clauses[c]));
 	
+	res->coeffs.setFromTriplets(terms.begin(), terms.end());
 	return res;
 }
 
-Problem* Problem::from3SAT(uint32_t n, std::vector<clause3>& clause3s, std::vector<clause2>& clause2s, std::vector<float>& literalWeights){
+Problem* Problem::from3SAT(uint32_t n, const std::vector<clause3>& clause3s, const std::vector<clause2>& clause2s, const std::vector<double>& literalWeights){
 	uint32_t m = clause3s.size(); //number of 3-clauses -> auxiliary variables
 	
+	//The 2-SAT part, exactly as from2SAT, but sized for the auxiliaries
+	Problem* res = new Problem(n+m+1);
+	Terms terms;
+	for(uint32_t i=1;i<=n;i++)
+		addLiteral(res, terms, literalWeights[i-1], i);
+	for(uint32_t c=0;c<clause2s.size();c++)
+		addClause2(res, terms, std::get<0>(clause2s[c]), std::get<1>(clause2s[c]), std::get<2>(clause2s[c]));
+	
 	//For each 3-clause, add a variable v
 	//10 clauses: (x_i)(x_j)(x_k)(v)
 	//       (~x_i|~x_j)(~x_j|~x_k)(~x_i|~x_k)
 	//       (x_i|~v)(x_j|~v)(x_k|~v)
-	for(uint32_t c=0; c<clause3s.size(); c++){
-		auto c3 = clause3s[c];
-		float w = std::get<0>(c3);
-		
-		int xi = std::get<1>(c3);
-		int xj = std::get<2>(c3);
-		int xk = std::get<3>(c3);
+	//At most 7 of these hold if the 3-clause does, and 6 otherwise,
+	//so the reduction turns (0,w) into (6w,7w): subtract 6w.
+	for(uint32_t c=0; c<m; c++){
+		double w = std::get<0>(clause3s[c]);
+		int xi = std::get<1>(clause3s[c]);
+		int xj = std::get<2>(clause3s[c]);
+		int xk = std::get<3>(clause3s[c]);
 		int v = 1+n+c;
 		
+		addLiteral(res, terms, w, xi);
+		addLiteral(res, terms, w, xj);
+		addLiteral(res, terms, w, xk);
+		addLiteral(res, terms, w, v);
 		
-		literalWeights[abs(xi)] += w*(xi > 0 ? 1 : -1);
-		literalWeights[abs(xj)] += w*(xj > 0 ? 1 : -1);
-		literalWeights[abs(xk)] += w*(xk > 0 ? 1 : -1);
-		literalWeights.push_back(w); //v
+		addClause2(res, terms, w, -xi,-xj);
+		addClause2(res, terms, w, -xj,-xk);
+		addClause2(res, terms, w, -xi,-xk);
 		
-		clause2s.push_back({w, -xi,-xj});
-		clause2s.push_back({w, -xj,-xk});
-		clause2s.push_back({w, -xi,-xk});
+		addClause2(res, terms, w, xi,-v);
+		addClause2(res, terms, w, xj,-v);
+		addClause2(res, terms, w, xk,-v);
 		
-		clause2s.push_back({w, xi,-v});
-		clause2s.push_back({w, xj,-v});
-		clause2s.push_back({w, xk,-v});
-	}
-	
-	//Get problem as MAX2SAT instance
-	Problem* res = from2SAT(n+m, clause2s, literalWeights);
-	
-	//Adjust constant -- the above reduction turns (0,w) into (6w,7w).
-	for(uint32_t c=0; c<clause3s.size(); c++){
-		auto c3 = clause3s[c];
-		float w = std::get<0>(c3);
 		res->constantTerm -= 6*w;
 	}
 	
-	//cleanup modifications to literalWeights/clauses2
-	literalWeights.erase(literalWeights.begin()+n, literalWeights.end());
-	for(uint32_t c=0; c<clause3s.size(); c++){
-		auto c3 = clause3s[c];
-		float w = std::get<0>(c3);
-		
-		int xi = std::get<1>(c3);
-		int xj = std::get<2>(c3);
-		int xk = std::get<3>(c3);
-		
-		literalWeights[abs(xi)] -= w;
-		literalWeights[abs(xj)] -= w;
-		literalWeights[abs(xk)] -= w;
-	}
-	
-	clause2s.erase(clause2s.end()-6*m, clause2s.end());
-	
+	res->coeffs.setFromTriplets(terms.begin(), terms.end());
 	return res;
 }
 
-//Turn MAX-CLIQUE into a MAXQP problem. Given an n-vertex graph,
+//Turn MAX-CLIQUE into a MAXQP problem. A clique in g is an independent
+//set in its complement, so this penalizes every non-edge of g. That makes
+//the QP dense for sparse g, so the caller bounds how dense a complement
+//it's willing to build.
+Problem* Problem::fromMaxClique(const Graph& g, double maxComplementDensity){
+	double pairs = 0.5*g.n*(g.n-1.);
+	double complementEdges = pairs - g.numEdges();
+	if(complementEdges > maxComplementDensity*pairs)
+		throw std::runtime_error(std::string("Max clique complement too dense: ")+std::to_string((size_t)complementEdges)+" of "+std::to_string((size_t)pairs)+" pairs");
+	
+	return fromIndSet(g.complement());
+}
+
+//Turn MAX-INDEPENDENT-SET into a MAXQP problem. Given an n-vertex graph,
 //add an auxiliary variable v0 representing "true". Each other variable
 //corresponds to a vertex. It has a weight of 1 (so that v0*vi has a
-//coefficient of 1), representing a value of 1 of adding it to the clique.
-//We don't want to add any two vertices in the 'clique' to not share an edge,
-//so we have a penality of -k if they aren't connected in the adjacency matrix.
-//Any value of k > 1 will suffice, to fully "discourage" adding a bad
-//vertex. We take k=2 so that we get nice integral values along the way.
-Problem* Problem::fromMaxClique(uint32_t n, bool** adjMat){
-	uint32_t nQP = n+1;
+//coefficient of 1), representing a value of 1 of adding it to the set.
+//We don't want any two vertices in the set to share an edge, so we have
+//a penalty of -k for each edge of the graph. Any value of k > 1 will
+//suffice, to fully "discourage" adding a bad vertex. We take k=2 so that
+//we get nice integral values along the way.
+Problem* Problem::fromIndSet(const Graph& g){
+	uint32_t nQP = g.n+1;
 	
 	Problem* res = new Problem(nQP);
+	Terms terms;
+	terms.reserve(nQP + 1.5*g.adj.size());
 	
 	for(uint32_t i=1;i<nQP;i++){
-		res->coeffs(0, i) = 0.5;
+		terms.push_back({0, (int)i, 0.5});
 		res->constantTerm += 0.5;
 	}
-	float k = 2;
-	for(uint32_t i=1;i<nQP;i++){
-		for(uint32_t j=i+1;j<nQP;j++){
-			if(!adjMat[i][j]){
-				//add a penalty
-				//-k iff x==1 && y==1, or
-				//-k/4(1 + x + y + xy)
-				res->coeffs(0, i) -= k/4;
-				res->coeffs(0, j) -= k/4;
-				res->coeffs(i, j) -= k/4;
-				res->constantTerm -= k/4;
-			}
+	double k = 2;
+	for(uint32_t u=0;u<g.n;u++){
+		for(size_t a=g.offsets[u];a<g.offsets[u+1];a++){
+			uint32_t v = g.adj[a];
+			if(v < u) continue; //each edge once
+			//add a penalty
+			//-k iff x==1 && y==1, or
+			//-k/4(1 + x + y + xy)
+			uint32_t i = u+1, j = v+1;
+			terms.push_back({0, (int)i, -k/4});
+			terms.push_back({0, (int)j, -k/4});
+			terms.push_back({(int)i, (int)j, -k/4});
+			res->constantTerm -= k/4;
 		}
 	}
 	
+	res->coeffs.setFromTriplets(terms.begin(), terms.end());
 	return res;
 }
 
-Problem* Problem::fromIndSet(uint32_t n, bool** adjMat){
-	uint32_t nQP = n+1;
-	
-	Problem* res = new Problem(nQP);
+//Turn MAX-CUT into a MAXQP problem. Each vertex gets a variable, with
+//the sign being its side of the cut. An edge uv is cut iff x_u x_v = -1,
+//so it contributes (1 - x_u x_v)/2. No "true" variable is needed.
+Problem* Problem::fromMaxCut(const Graph& g){
+	Problem* res = new Problem(g.n);
+	Terms terms;
+	terms.reserve(g.adj.size()/2);
 	
-	for(uint32_t i=1;i<nQP;i++){
-		res->coeffs(0, i) = 0.5;
-		res->constantTerm += 0.5;
-	}
-	float k = 2;
-	for(uint32_t i=1;i<nQP;i++){
-		for(uint32_t j=i+1;j<nQP;j++){
-			if(adjMat[i][j]){
-				//add a penalty
-				//-k iff x==1 && y==1, or
-				//-k/4(1 + x + y + xy)
-				res->coeffs(0, i) -= k/4;
-				res->coeffs(0, j) -= k/4;
-				res->coeffs(i, j) -= k/4;
-				res->constantTerm -= k/4;
-			}
+	for(uint32_t u=0;u<g.n;u++){
+		for(size_t a=g.offsets[u];a<g.offsets[u+1];a++){
+			uint32_t v = g.adj[a];
+			if(v < u) continue; //each edge once
+			terms.push_back({(int)u, (int)v, -0.5});
+			res->constantTerm += 0.5;
 		}
 	}
 	
+	res->coeffs.setFromTriplets(terms.begin(), terms.end());
 	return res;
 }
 
-float Problem::score(VectorXd sol){
-	return constantTerm + sol.transpose() * coeffs * sol;
+double Problem::score(const VectorXd& sol) const {
+	return constantTerm + sol.dot(coeffs * sol);
 }
\ No newline at end of file
@@ -2,17 +2,21 @@
 
 #include <vector>
 #include <Eigen/Dense>
+#include <Eigen/Sparse>
 #include <utility>		// std::pair, std::get
 #include <stdlib.h>     /* abs */
 #include <algorithm>    // std::min, std::max
 #include <tuple>
 
+#include "Graph.hpp"
+
 using Eigen::MatrixXd;
 using Eigen::VectorXd;
+using Eigen::SparseMatrix;
 
 typedef unsigned int uint32_t;
-typedef std::tuple<float,int,int> clause2;
-typedef std::tuple<float,int,int,int> clause3;
+typedef std::tuple<double,int,int> clause2;
+typedef std::tuple<double,int,int,int> clause3;
 
 //Represents a MAXQP problem
 class Problem 
@@ -20,35 +24,46 @@ class Problem
  public: 
   uint32_t nQP; //total variables in the QP
   
-  MatrixXd& coeffs; //strictly uppertriangular
+  //Strictly upper triangular and sparse, so that a problem costs memory
+  //for its terms, not for every pair of variables. Column j lists the
+  //terms x_i x_j with i < j, row 0 the linear ones.
+  SparseMatrix<double>& coeffs;
   
   //used to define a "shift" in the objective function. Doesn't
   //affect the search or what the ideal solution is, but is added
   //to the objective value
-  float constantTerm;
+  double constantTerm;
   
   //Score a proposed solution
-  float score(VectorXd sol);
+  double score(const VectorXd& sol) const;
   
   //Initialize a problem with 0 objective function
   Problem(uint32_t n);
   
   //Initialize a problem with given matrix and constant
-  Problem(uint32_t n, MatrixXd& coeff, float constantTerm);
+  Problem(uint32_t n, SparseMatrix<double>& coeff, double constantTerm);
   
   //Initialize a problem from a MAX2SAT problem with per-clause and per-var weight
   //Requires one auxiliary variable to represent "true"
-  static Problem* from2SAT(uint32_t n, std::vector<clause2>& clauses, std::vector<float>& literalWeights);
+  static Problem* from2SAT(uint32_t n, const std::vector<clause2>& clauses, const std::vector<double>& literalWeights);
   
   //Initialize a problem from a MAX3SAT problem with per-clause and per-var weight
   //Requires one auxiliary variable to represnet "true", and one auxiliary
-  //for each clause
-  static Problem* from3SAT(uint32_t n, std::vector<clause3>& clause3s, std::vector<clause2>& clause2s, std::vector<float>& literalWeights);
+  //for each clause. Builds the problem in one pass, without touching the inputs.
+  static Problem* from3SAT(uint32_t n, const std::vector<clause3>& clause3s, const std::vector<clause2>& clause2s, const std::vector<double>& literalWeights);
+  
+  //Initialize a MAXQP problem from a max-clique instance. This is
+  //fromIndSet on the complement graph, with one penalty per non-edge; if
+  //the complement has more than maxComplementDensity*n(n-1)/2 edges this
+  //throws before building it. By default only graphs with at least 90% of
+  //all edges are taken; pass 1 to take any graph.
+  static Problem* fromMaxClique(const Graph& g, double maxComplementDensity = 0.1);
   
-  //Initialize a MAXQP problem from a max-clique instance
-  static Problem* fromMaxClique(uint32_t n, bool** adjMat);
+  //Initialize a MAXQP problem from a max-independent set instance.
+  //Vertex v becomes variable v+1. O(n+m) in time and memory.
+  static Problem* fromIndSet(const Graph& g);
   
-  //Initialize a MAXQP problem from a max-independent set instance
-  //This is equivalent to fromMaxClique with a negated adjMat
-  static Problem* fromIndSet(uint32_t n, bool** adjMat);
+  //Initialize a MAXQP problem from an (unweighted) max-cut instance:
+  //the score is the number of edges cut. Vertex v is variable v.
+  static Problem* fromMaxCut(const Graph& g);
 }; 
\ No newline at end of file
@@ -0,0 +1,40 @@
+#include "RemovalPolicy.hpp"
+
+#include <algorithm>
+
+void ThresholdRemovalPolicy::select(const std::vector<RowInfo>& rows, const RoundState& state, std::vector<uint32_t>& remove){
+	if(state.boundImprovement < stallImprovement)
+		threshold += increment;
+	else
+		threshold = minimum;
+
+	for(uint32_t r=0;r<rows.size();r++)
+		if(rows[r].slack > threshold)
+			remove.push_back(r);
+}
+
+void AgingRemovalPolicy::select(const std::vector<RowInfo>& rows, const RoundState& state, std::vector<uint32_t>& remove){
+	std::vector<uint32_t> candidates;
+	uint32_t kept = 0;
+	for(uint32_t r=0;r<rows.size();r++){
+		if(rows[r].slackRounds >= slackRounds)
+			remove.push_back(r);
+		else {
+			kept++;
+			if(rows[r].slackRounds > 0 && state.round - rows[r].born >= graceRounds)
+				candidates.push_back(r);
+		}
+	}
+
+	if(maxRows == 0 || kept <= maxRows)
+		return;
+
+	//Over the cap: evict the least useful of the rows that are slack now
+	std::sort(candidates.begin(), candidates.end(), [&](uint32_t a, uint32_t b){
+		if(rows[a].slackRounds != rows[b].slackRounds)
+			return rows[a].slackRounds > rows[b].slackRounds;
+		return rows[a].dualAverage < rows[b].dualAverage;
+	});
+	for(uint32_t i=0;i<candidates.size() && kept > maxRows;i++,kept--)
+		remove.push_back(candidates[i]);
+}
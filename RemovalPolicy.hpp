@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+
+//What the solver keeps about each row (cut) of the LP, in row order
+struct RowInfo {
+	uint64_t signature;    //hash of the row, to notice cuts found again
+	uint32_t born;         //round it was added in
+	uint32_t slackRounds;  //consecutive rounds it has been non-binding, up to now
+	double slack;          //activity minus right side, at the last LP solution
+	double dual;           //its dual value at the last LP solution
+	double dualAverage;    //exponentially decayed average of |dual|
+};
+
+//The state of the solve when rows are picked for removal
+struct RoundState {
+	uint32_t round;
+	double boundImprovement; //how much the upper bound dropped this round
+};
+
+//Decides which rows to take out of the LP after each solve. Each LPSolver
+//owns one; set it with LPSolver::setRemovalPolicy.
+class RemovalPolicy
+{
+ public:
+	virtual ~RemovalPolicy(){}
+
+	//Append the (0-indexed) rows to remove to 'remove', in any order.
+	//'rows' is up to date with the solution just found.
+	virtual void select(const std::vector<RowInfo>& rows, const RoundState& state, std::vector<uint32_t>& remove) = 0;
+};
+
+//The original rule: remove every row with slack above a threshold. The
+//threshold grows by 'increment' each round the bound improves by less than
+//'stallImprovement', and goes back to 'minimum' when it improves more.
+class ThresholdRemovalPolicy : public RemovalPolicy
+{
+ public:
+	ThresholdRemovalPolicy(double minimum = 0.99, double increment = 0.0, double stallImprovement = 0.001)
+		: minimum(minimum), increment(increment), stallImprovement(stallImprovement), threshold(minimum) {}
+
+	void select(const std::vector<RowInfo>& rows, const RoundState& state, std::vector<uint32_t>& remove);
+
+ private:
+	double minimum, increment, stallImprovement;
+	double threshold;
+};
+
+//Removes rows that have been non-binding for 'slackRounds' rounds in a row,
+//so that a cut that is slack for one round but needed again the next isn't
+//thrown away and found again. If more than 'maxRows' rows remain (0: no
+//cap), the non-binding rows that have been slack longest, and then those
+//with the smallest dual history, go too. Binding rows are never removed,
+//and neither are rows added in the last 'graceRounds' rounds to meet the
+//cap, which they may then exceed. A row added in round r is first solved
+//in round r+1, next to the rest of its batch, so the default of 2 lets it
+//be slack through that one solve before the cap can take it.
+class AgingRemovalPolicy : public RemovalPolicy
+{
+ public:
+	AgingRemovalPolicy(uint32_t slackRounds = 5, uint32_t maxRows = 0, uint32_t graceRounds = 2)
+		: slackRounds(slackRounds), maxRows(maxRows), graceRounds(graceRounds) {}
+
+	void select(const std::vector<RowInfo>& rows, const RoundState& state, std::vector<uint32_t>& remove);
+
+ private:
+	uint32_t slackRounds;
+	uint32_t maxRows;
+	uint32_t graceRounds;
+};
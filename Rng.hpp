@@ -0,0 +1,105 @@
+#pragma once
+
+#include <stdint.h>
+#include <math.h>
+#include <utility>
+
+//Small, fast random number generator: xoshiro256** seeded through
+//splitmix64. It satisfies UniformRandomBitGenerator, but std::shuffle and
+//the std distributions are implementation-defined; below(), normal() and
+//shuffle() give the same sequence with every standard library, so runs are
+//reproducible everywhere from the seed alone.
+//
+//Not thread-safe: give each thread its own, made with split().
+class Rng
+{
+ public:
+	typedef uint64_t result_type;
+	static constexpr result_type min(){ return 0; }
+	static constexpr result_type max(){ return UINT64_MAX; }
+
+	explicit Rng(uint64_t seed = 0){
+		reseed(seed);
+	}
+
+	void reseed(uint64_t seed){
+		for(int i=0;i<4;i++) s[i] = splitmix(seed);
+		hasSpare = false;
+	}
+
+	result_type operator()(){
+		uint64_t result = rotl(s[1] * 5, 7) * 9;
+		uint64_t t = s[1] << 17;
+		s[2] ^= s[0];
+		s[3] ^= s[1];
+		s[1] ^= s[2];
+		s[0] ^= s[3];
+		s[2] ^= t;
+		s[3] = rotl(s[3], 45);
+		return result;
+	}
+
+	//A new generator whose stream is independent of this one's. Splitting
+	//the same generator the same way always gives the same children, so
+	//per-thread streams made with split() keep parallel runs deterministic.
+	Rng split(){
+		return Rng((*this)());
+	}
+
+	//Uniform in [0, n), without modulo bias (Lemire's method)
+	uint32_t below(uint32_t n){
+		uint64_t m = (uint64_t)(uint32_t)((*this)() >> 32) * n;
+		if((uint32_t)m < n){
+			uint32_t threshold = -n % n;
+			while((uint32_t)m < threshold)
+				m = (uint64_t)(uint32_t)((*this)() >> 32) * n;
+		}
+		return m >> 32;
+	}
+
+	//Put [first, last) in uniformly random order (Fisher-Yates)
+	template<typename It>
+	void shuffle(It first, It last){
+		for(uint32_t i=last-first;i>1;i--)
+			std::swap(first[i-1], first[below(i)]);
+	}
+
+	//Uniform in [0, 1)
+	double uniform(){
+		return ((*this)() >> 11) * 0x1.0p-53;
+	}
+
+	//Standard normal, by the Marsaglia polar method
+	double normal(){
+		if(hasSpare){
+			hasSpare = false;
+			return spare;
+		}
+		double u, v, r;
+		do {
+			u = 2*uniform() - 1;
+			v = 2*uniform() - 1;
+			r = u*u + v*v;
+		} while(r >= 1 || r == 0);
+		double f = sqrt(-2*log(r)/r);
+		spare = v*f;
+		hasSpare = true;
+		return u*f;
+	}
+
+ private:
+	static uint64_t rotl(uint64_t x, int k){
+		return (x << k) | (x >> (64 - k));
+	}
+
+	static uint64_t splitmix(uint64_t& x){
+		uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	uint64_t s[4];
+	bool hasSpare;
+	double spare;
+};
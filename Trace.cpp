@@ -0,0 +1,72 @@
+#include "Trace.hpp"
+
+//Distinguishes recorders in the per-thread cache, even if one is
+//allocated where an old one used to be
+static std::atomic<uint64_t> nextRecorderId(1);
+
+TraceRecorder::TraceRecorder(size_t eventsPerThread) : capacity(eventsPerThread), id(nextRecorderId++), origin(std::chrono::steady_clock::now()) {
+}
+
+TraceRecorder::ThreadBuffer* TraceRecorder::threadBuffer(){
+	//the buffer this thread used last, and for which recorder
+	thread_local uint64_t cachedId = 0;
+	thread_local ThreadBuffer* cached = NULL;
+	if(cachedId == id)
+		return cached;
+
+	std::lock_guard<std::mutex> lock(registration);
+	std::thread::id self = std::this_thread::get_id();
+	ThreadBuffer* buf = NULL;
+	for(auto& b : buffers){
+		if(b->thread == self){
+			buf = b.get();
+			break;
+		}
+	}
+	if(buf == NULL){
+		buf = new ThreadBuffer();
+		buf->thread = self;
+		buf->tid = buffers.size();
+		buf->events.resize(capacity);
+		buf->written = 0;
+		buffers.emplace_back(buf);
+	}
+	cachedId = id;
+	cached = buf;
+	return buf;
+}
+
+void TraceRecorder::record(const char* name, uint64_t start, uint64_t duration){
+	if(capacity == 0) return;
+	ThreadBuffer* buf = threadBuffer();
+	uint64_t w = buf->written.load(std::memory_order_relaxed);
+	buf->events[w % capacity] = {name, start, duration};
+	buf->written.store(w+1, std::memory_order_release);
+}
+
+void TraceRecorder::write(FILE* out) const {
+	fprintf(out, "{\"traceEvents\": [\n");
+	bool first = true;
+	for(auto& b : buffers){
+		fprintf(out, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"args\": {\"name\": \"thread %u\"}}",
+			first ? "" : ",\n", b->tid, b->tid);
+		first = false;
+
+		uint64_t n = b->written.load(std::memory_order_acquire);
+		uint64_t begin = n > capacity ? n - capacity : 0;
+		for(uint64_t i=begin;i<n;i++){
+			const TraceEvent& e = b->events[i % capacity];
+			fprintf(out, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}",
+				e.name, b->tid, e.start/1000., e.duration/1000.);
+		}
+	}
+	fprintf(out, "\n], \"displayTimeUnit\": \"ms\"}\n");
+}
+
+bool TraceRecorder::write(const char* path) const {
+	FILE* out = fopen(path, "w");
+	if(out == NULL)
+		return false;
+	write(out);
+	return fclose(out) == 0;
+}
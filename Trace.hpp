@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include <stdint.h>
+
+//One span on one thread. Times are in nanoseconds since the recorder was made.
+struct TraceEvent {
+	const char* name; //not copied: use string literals
+	uint64_t start;
+	uint64_t duration;
+};
+
+//Collects spans from any number of threads and writes them in the Chrome
+//trace event format, for chrome://tracing or ui.perfetto.dev.
+//Each thread records into its own fixed-size ring buffer, so recording takes
+//no locks; a thread locks once, the first time it records, to register its
+//buffer. When a buffer is full the oldest events are overwritten.
+class TraceRecorder
+{
+ public:
+	TraceRecorder(size_t eventsPerThread = 1<<16);
+
+	uint64_t now() const {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+	}
+
+	void record(const char* name, uint64_t start, uint64_t duration);
+
+	//Write everything buffered as Chrome trace JSON. Call while no thread is recording.
+	void write(FILE* out) const;
+	bool write(const char* path) const;
+
+ private:
+	struct ThreadBuffer {
+		std::thread::id thread;
+		uint32_t tid;
+		std::vector<TraceEvent> events;
+		std::atomic<uint64_t> written;
+	};
+
+	ThreadBuffer* threadBuffer();
+
+	size_t capacity;
+	uint64_t id;
+	std::chrono::steady_clock::time_point origin;
+	std::mutex registration;
+	std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+//Records a span from construction to destruction. Does nothing if the recorder is NULL.
+class ScopedTrace
+{
+ public:
+	ScopedTrace(TraceRecorder* t, const char* n) : trace(t), name(n), start(t ? t->now() : 0) {}
+	~ScopedTrace(){
+		if(trace) trace->record(name, start, trace->now() - start);
+	}
+
+ private:
+	TraceRecorder* trace;
+	const char* name;
+	uint64_t start;
+};
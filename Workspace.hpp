@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <Eigen/Dense>
+
+typedef unsigned int uint32_t;
+
+//Scratch space for the core search, so that growing and shrinking cores
+//doesn't allocate. Holds one k x k matrix and one eigensolver per core size
+//k, each created the first time that size is asked for and reused after.
+//Not shared between threads: each solver (or worker) owns its own.
+//Real is the precision of the matrices: double, or float for screening.
+template<typename Real>
+class WorkspaceT
+{
+ public:
+	typedef Eigen::Matrix<Real, Eigen::Dynamic, Eigen::Dynamic> Matrix;
+
+	Matrix& matrix(uint32_t k){
+		grow(k);
+		return *matrices[k];
+	}
+
+	Eigen::SelfAdjointEigenSolver<Matrix>& eigenSolver(uint32_t k){
+		grow(k);
+		return *solvers[k];
+	}
+
+	//Scratch list of row indices
+	std::vector<uint32_t> rows;
+
+ private:
+	void grow(uint32_t k){
+		if(k >= matrices.size()){
+			matrices.resize(k+1);
+			solvers.resize(k+1);
+		}
+		if(!matrices[k]){
+			matrices[k].reset(new Matrix(k, k));
+			solvers[k].reset(new Eigen::SelfAdjointEigenSolver<Matrix>(k));
+		}
+	}
+
+	std::vector<std::unique_ptr<Matrix>> matrices;
+	std::vector<std::unique_ptr<Eigen::SelfAdjointEigenSolver<Matrix>>> solvers;
+};
+
+typedef WorkspaceT<double> Workspace;
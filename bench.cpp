@@ -0,0 +1,460 @@
+#include "Problem.hpp"
+#include "DecomposedSolver.hpp"
+#include "Presolve.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <cmath>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+//Fixed corpus of instances, each solved in its own process so that peak
+//RSS is per instance and an LP failure (which exits) only loses that one.
+//
+//Usage: bench [--format csv|json] [--out FILE] [--baseline FILE.csv]
+//             [--filter SUBSTRING] [--max-rounds N] [--timeout SECONDS]
+//             [--target-gap G] [--tolerance T] [--threads N] [--seed S]
+//             [--presolve] [--decompose] [--parallel-components]
+//             [--lp glpk-simplex|glpk-interior|pdlp]
+//             [--early-lp] [--list]
+
+struct Instance {
+	std::string name;
+	std::string family;
+	std::function<Problem*()> build;
+};
+
+struct Result {
+	std::string name;
+	std::string family;
+	std::string status; //ok, failed or timeout
+	uint32_t nQP;
+	uint32_t fixed; //by presolve
+	double seconds;
+	double timeToBound; //seconds until the solver's own gap first closed to target, -1 if never
+	double lowerBound;
+	double upperBound;
+	double gap;
+	uint32_t rounds;
+	uint64_t cuts;
+	long peakRSS; //KiB
+};
+
+//What the child process sends back
+struct Measured {
+	uint32_t nQP;
+	uint32_t fixed;
+	double seconds;
+	double timeToBound;
+	double lowerBound;
+	double upperBound;
+	uint32_t rounds;
+	uint64_t cuts;
+};
+
+//The generators only use the raw mt19937_64 output, which the standard
+//pins down, so the corpus is the same with every standard library. Keep
+//it that way: saved baselines are only comparable on the same corpus.
+//(Rng, which seeds the solver, is for the solver's own randomness.)
+static uint32_t below(std::mt19937_64& rng, uint32_t n){
+	return rng() % n;
+}
+
+//Random literal in 1..n, with a random sign
+static int randomLiteral(std::mt19937_64& rng, uint32_t n){
+	int v = 1 + below(rng, n);
+	return below(rng, 2) ? v : -v;
+}
+
+static Problem* randomMax2SAT(uint32_t n, double density, uint64_t seed){
+	std::mt19937_64 rng(seed);
+	std::vector<clause2> clauses;
+	uint32_t m = lround(density*n);
+	for(uint32_t i=0;i<m;i++){
+		int a = randomLiteral(rng, n), b;
+		do b = randomLiteral(rng, n); while(abs(b) == abs(a));
+		clauses.push_back(clause2(1, a, b));
+	}
+	return Problem::from2SAT(n, clauses, std::vector<double>(n, 0));
+}
+
+//Random 3-SAT where every clause is satisfied by a hidden assignment
+static Problem* planted3SAT(uint32_t n, double density, uint64_t seed){
+	std::mt19937_64 rng(seed);
+	std::vector<int> planted(n+1);
+	for(uint32_t i=1;i<=n;i++) planted[i] = below(rng, 2) ? 1 : -1;
+
+	std::vector<clause3> clauses;
+	uint32_t m = lround(density*n);
+	for(uint32_t i=0;i<m;i++){
+		int lits[3];
+		bool satisfied;
+		do {
+			for(int k=0;k<3;k++){
+				bool repeat;
+				do {
+					lits[k] = randomLiteral(rng, n);
+					repeat = false;
+					for(int l=0;l<k;l++) repeat |= abs(lits[l]) == abs(lits[k]);
+				} while(repeat);
+			}
+			satisfied = false;
+			for(int k=0;k<3;k++) satisfied |= lits[k]*planted[abs(lits[k])] > 0;
+		} while(!satisfied);
+		clauses.push_back(clause3(1, lits[0], lits[1], lits[2]));
+	}
+	return Problem::from3SAT(n, clauses, std::vector<clause2>(), std::vector<double>(n, 0));
+}
+
+static Problem* gnpIndSet(uint32_t n, double p, uint64_t seed){
+	std::mt19937_64 rng(seed);
+	std::vector<std::pair<uint32_t,uint32_t>> edges;
+	for(uint32_t u=0;u<n;u++)
+		for(uint32_t v=u+1;v<n;v++)
+			if((rng() >> 11) * 0x1.0p-53 < p) edges.push_back({u, v});
+	return Problem::fromIndSet(Graph::fromEdges(n, edges));
+}
+
+//L x L grid with wraparound. Odd L makes it non-bipartite.
+static Problem* torusMaxCut(uint32_t L){
+	std::vector<std::pair<uint32_t,uint32_t>> edges;
+	for(uint32_t i=0;i<L;i++){
+		for(uint32_t j=0;j<L;j++){
+			edges.push_back({i*L+j, i*L+(j+1)%L});
+			edges.push_back({i*L+j, ((i+1)%L)*L+j});
+		}
+	}
+	return Problem::fromMaxCut(Graph::fromEdges(L*L, edges));
+}
+
+static std::vector<Instance> corpus(){
+	std::vector<Instance> res;
+	char name[64];
+	for(double density : {2.0, 4.0, 8.0}){
+		for(uint64_t seed : {1, 2}){
+			snprintf(name, sizeof(name), "max2sat-n40-d%g-s%llu", density, (unsigned long long)seed);
+			res.push_back({name, "max2sat", [=]{ return randomMax2SAT(40, density, seed); }});
+		}
+	}
+	for(uint64_t seed : {1, 2}){
+		snprintf(name, sizeof(name), "planted3sat-n16-d4.26-s%llu", (unsigned long long)seed);
+		res.push_back({name, "planted3sat", [=]{ return planted3SAT(16, 4.26, seed); }});
+	}
+	for(double p : {0.1, 0.3}){
+		snprintf(name, sizeof(name), "gnp-indset-n40-p%g-s1", p);
+		res.push_back({name, "indset", [=]{ return gnpIndSet(40, p, 1); }});
+	}
+	for(uint32_t L : {5, 7, 9}){
+		snprintf(name, sizeof(name), "torus-maxcut-%ux%u", L, L);
+		res.push_back({name, "maxcut", [=]{ return torusMaxCut(L); }});
+	}
+	return res;
+}
+
+static double relativeGap(double lb, double ub){
+	return (ub - lb) / std::max(1.0, fabs(lb));
+}
+
+//Runs in the child process
+static Measured runInstance(const Instance& inst, const LPSolverConfig& config, double targetGap, bool presolve, bool decompose){
+	Problem* p = inst.build();
+	Measured m;
+	m.nQP = p->nQP;
+	m.fixed = 0;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	PresolveConfig presolveConfig;
+	presolveConfig.dominance = presolveConfig.roofDuality = presolve;
+	Presolve reduction(*p, presolveConfig);
+	double presolveSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	m.fixed = reduction.numFixed();
+
+	if(decompose){
+		//no per-round history across components, so no time to bound
+		DecomposedSolver solver(reduction.reduced, config);
+		solver.solve();
+		m.seconds = presolveSeconds + solver.metrics.elapsed();
+		m.timeToBound = -1;
+		m.lowerBound = solver.lowerBound;
+		m.upperBound = solver.upperBound;
+		m.rounds = solver.metrics.rounds;
+		m.cuts = solver.metrics.totalCount[COUNT_CUTS_ADDED];
+		return m;
+	}
+	
+	if(reduction.reduced->nQP < 2){
+		//nothing left for the LP
+		VectorXd all(1);
+		all(0) = 1;
+		m.seconds = m.timeToBound = presolveSeconds;
+		m.lowerBound = m.upperBound = p->score(reduction.expand(all));
+		m.rounds = 0;
+		m.cuts = 0;
+		return m;
+	}
+
+	LPSolver solver(reduction.reduced, config);
+	solver.solve();
+
+	m.seconds = presolveSeconds + solver.metrics.elapsed();
+	m.lowerBound = solver.lowerBound;
+	m.upperBound = solver.upperBound;
+	m.rounds = solver.metrics.rounds;
+	m.cuts = solver.metrics.totalCount[COUNT_CUTS_ADDED];
+	m.timeToBound = -1;
+	//The gap the solver had at the end of each round, not the final lower
+	//bound against earlier upper bounds
+	for(auto& r : solver.metrics.history){
+		if(relativeGap(r.lowerBound, r.upperBound) <= targetGap){
+			m.timeToBound = presolveSeconds + r.seconds;
+			break;
+		}
+	}
+	return m;
+}
+
+static Result runIsolated(const Instance& inst, const LPSolverConfig& config, double targetGap, bool presolve, bool decompose, double timeout){
+	Result res;
+	res.name = inst.name;
+	res.family = inst.family;
+	res.status = "failed";
+	res.nQP = res.fixed = 0;
+	res.seconds = res.timeToBound = res.lowerBound = res.upperBound = res.gap = 0;
+	res.rounds = 0;
+	res.cuts = 0;
+	res.peakRSS = 0;
+
+	int fds[2];
+	if(pipe(fds) != 0)
+		throw std::runtime_error("pipe failed");
+	fflush(stdout);
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	pid_t pid = fork();
+	if(pid < 0)
+		throw std::runtime_error("fork failed");
+	if(pid == 0){
+		close(fds[0]);
+		Measured m = runInstance(inst, config, targetGap, presolve, decompose);
+		ssize_t written = write(fds[1], &m, sizeof(m));
+		_exit(written == sizeof(m) ? 0 : 1);
+	}
+	close(fds[1]);
+
+	int status = 0;
+	struct rusage usage;
+	memset(&usage, 0, sizeof(usage));
+	//Whether we learned how the child ended; if wait4 fails for any reason
+	//but a signal, we can't, and the run counts as failed
+	bool reaped = false;
+	double waited = 0;
+	while(true){
+		pid_t done = wait4(pid, &status, WNOHANG, &usage);
+		if(done == pid){
+			reaped = true;
+			break;
+		}
+		if(done < 0){
+			if(errno == EINTR) continue;
+			break;
+		}
+		waited = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if(timeout > 0 && waited > timeout){
+			kill(pid, SIGKILL);
+			while(wait4(pid, &status, 0, &usage) < 0 && errno == EINTR);
+			res.status = "timeout";
+			break;
+		}
+		usleep(10000);
+	}
+	waited = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	res.peakRSS = usage.ru_maxrss;
+
+	Measured m;
+	if(reaped && read(fds[0], &m, sizeof(m)) == sizeof(m) && WIFEXITED(status) && WEXITSTATUS(status) == 0){
+		res.status = "ok";
+		res.nQP = m.nQP;
+		res.fixed = m.fixed;
+		res.seconds = m.seconds;
+		res.timeToBound = m.timeToBound;
+		res.lowerBound = m.lowerBound;
+		res.upperBound = m.upperBound;
+		res.gap = relativeGap(m.lowerBound, m.upperBound);
+		res.rounds = m.rounds;
+		res.cuts = m.cuts;
+	} else {
+		res.seconds = waited;
+	}
+	close(fds[0]);
+	return res;
+}
+
+static const char* CSV_HEADER = "instance,family,n,fixed,status,seconds,time_to_bound,lower_bound,upper_bound,gap,rounds,cuts,peak_rss_kb";
+
+static void writeCSV(std::ostream& out, const std::vector<Result>& results){
+	out << CSV_HEADER << "\n";
+	char line[512];
+	for(auto& r : results){
+		snprintf(line, sizeof(line), "%s,%s,%u,%u,%s,%.6f,%.6f,%.9g,%.9g,%.9g,%u,%llu,%ld",
+			r.name.c_str(), r.family.c_str(), r.nQP, r.fixed, r.status.c_str(), r.seconds, r.timeToBound,
+			r.lowerBound, r.upperBound, r.gap, r.rounds, (unsigned long long)r.cuts, r.peakRSS);
+		out << line << "\n";
+	}
+}
+
+static void writeJSON(std::ostream& out, const std::vector<Result>& results){
+	out << "[\n";
+	char line[768];
+	for(uint32_t i=0;i<results.size();i++){
+		const Result& r = results[i];
+		snprintf(line, sizeof(line), "  {\"instance\": \"%s\", \"family\": \"%s\", \"n\": %u, \"fixed\": %u, \"status\": \"%s\", "
+			"\"seconds\": %.6f, \"time_to_bound\": %.6f, \"lower_bound\": %.9g, \"upper_bound\": %.9g, "
+			"\"gap\": %.9g, \"rounds\": %u, \"cuts\": %llu, \"peak_rss_kb\": %ld}%s",
+			r.name.c_str(), r.family.c_str(), r.nQP, r.fixed, r.status.c_str(), r.seconds, r.timeToBound,
+			r.lowerBound, r.upperBound, r.gap, r.rounds, (unsigned long long)r.cuts, r.peakRSS,
+			i+1 < results.size() ? "," : "");
+		out << line << "\n";
+	}
+	out << "]\n";
+}
+
+//Rows of a CSV written by writeCSV, keyed by instance and then by column
+static std::map<std::string, std::map<std::string,std::string>> readCSV(const std::string& path){
+	std::ifstream in(path);
+	if(!in)
+		throw std::runtime_error("cannot read baseline " + path);
+	std::string line, cell;
+	std::vector<std::string> header;
+	std::map<std::string, std::map<std::string,std::string>> rows;
+	while(std::getline(in, line)){
+		if(line.empty()) continue;
+		std::vector<std::string> cells;
+		std::stringstream ss(line);
+		while(std::getline(ss, cell, ',')) cells.push_back(cell);
+		if(header.empty()){
+			header = cells;
+			continue;
+		}
+		std::map<std::string,std::string> row;
+		for(uint32_t i=0;i<cells.size() && i<header.size();i++) row[header[i]] = cells[i];
+		rows[row["instance"]] = row;
+	}
+	return rows;
+}
+
+//Print how each result compares to the baseline; returns the number of regressions.
+//A regression is a run that no longer finishes, a wider gap, or a slowdown of
+//more than 'tolerance' (relative) that is also above timer noise.
+static uint32_t compare(const std::vector<Result>& results, const std::string& baselinePath, double tolerance){
+	auto baseline = readCSV(baselinePath);
+	uint32_t regressions = 0;
+	fprintf(stderr, "%-32s %10s %10s %8s %12s %12s\n", "instance", "base s", "new s", "ratio", "base gap", "new gap");
+	for(auto& r : results){
+		auto it = baseline.find(r.name);
+		if(it == baseline.end()){
+			fprintf(stderr, "%-32s (not in baseline)\n", r.name.c_str());
+			continue;
+		}
+		auto& b = it->second;
+		double baseSeconds = atof(b["seconds"].c_str());
+		double baseGap = atof(b["gap"].c_str());
+		double ratio = baseSeconds > 0 ? r.seconds / baseSeconds : 1;
+
+		const char* verdict = "";
+		if(b["status"] == "ok" && r.status != "ok")
+			verdict = "REGRESSION (status)";
+		else if(r.gap > baseGap + 1e-6)
+			verdict = "REGRESSION (gap)";
+		else if(ratio > 1 + tolerance && r.seconds - baseSeconds > 0.05)
+			verdict = "REGRESSION (time)";
+		else if(ratio < 1 - tolerance && baseSeconds - r.seconds > 0.05)
+			verdict = "faster";
+		if(strncmp(verdict, "REGRESSION", 10) == 0) regressions++;
+
+		fprintf(stderr, "%-32s %10.3f %10.3f %8.2f %12.3g %12.3g %s\n", r.name.c_str(), baseSeconds, r.seconds, ratio, baseGap, r.gap, verdict);
+	}
+	fprintf(stderr, "%u regression(s)\n", regressions);
+	return regressions;
+}
+
+int main(int argc, char** argv){
+	std::string format = "csv", outPath, baselinePath, filter;
+	double timeout = 300, targetGap = 0.01, tolerance = 0.2;
+	bool list = false, presolve = false, decompose = false;
+	LPSolverConfig config;
+	config.verbose = false;
+	config.maxRounds = 500;
+
+	for(int i=1;i<argc;i++){
+		std::string arg = argv[i];
+		bool hasValue = i+1 < argc;
+		if(arg == "--list") list = true;
+		else if(arg == "--presolve") presolve = true;
+		else if(arg == "--decompose") decompose = true;
+		else if(arg == "--parallel-components") decompose = config.parallelComponents = true;
+		else if(arg == "--format" && hasValue) format = argv[++i];
+		else if(arg == "--out" && hasValue) outPath = argv[++i];
+		else if(arg == "--baseline" && hasValue) baselinePath = argv[++i];
+		else if(arg == "--filter" && hasValue) filter = argv[++i];
+		else if(arg == "--max-rounds" && hasValue) config.maxRounds = atoi(argv[++i]);
+		else if(arg == "--timeout" && hasValue) timeout = atof(argv[++i]);
+		else if(arg == "--target-gap" && hasValue) targetGap = atof(argv[++i]);
+		else if(arg == "--tolerance" && hasValue) tolerance = atof(argv[++i]);
+		else if(arg == "--threads" && hasValue) config.threads = atoi(argv[++i]);
+		else if(arg == "--seed" && hasValue) config.seed = strtoull(argv[++i], NULL, 10);
+		else if(arg == "--lp" && hasValue && lpEngineFromName(argv[i+1], config.lpEngine)) i++;
+		else if(arg == "--early-lp") config.earlyTermination = true;
+		else {
+			fprintf(stderr, "Usage: %s [--format csv|json] [--out FILE] [--baseline FILE.csv] [--filter SUBSTRING]\n"
+				"       [--max-rounds N] [--timeout SECONDS] [--target-gap G] [--tolerance T] [--threads N] [--seed S] [--presolve]\n"
+				"       [--decompose] [--parallel-components] [--lp glpk-simplex|glpk-interior|pdlp]\n"
+				"       [--early-lp] [--list]\n", argv[0]);
+			return 2;
+		}
+	}
+	if(format != "csv" && format != "json"){
+		fprintf(stderr, "Unknown format %s\n", format.c_str());
+		return 2;
+	}
+
+	std::vector<Result> results;
+	for(auto& inst : corpus()){
+		if(!filter.empty() && inst.name.find(filter) == std::string::npos) continue;
+		if(list){
+			std::cout << inst.name << std::endl;
+			continue;
+		}
+		fprintf(stderr, "%s... ", inst.name.c_str());
+		results.push_back(runIsolated(inst, config, targetGap, presolve, decompose, timeout));
+		fprintf(stderr, "%s %.3fs\n", results.back().status.c_str(), results.back().seconds);
+	}
+	if(list) return 0;
+
+	std::ofstream file;
+	if(!outPath.empty()){
+		file.open(outPath);
+		if(!file){
+			fprintf(stderr, "Cannot write %s\n", outPath.c_str());
+			return 2;
+		}
+	}
+	std::ostream& out = outPath.empty() ? std::cout : file;
+	if(format == "csv")
+		writeCSV(out, results);
+	else
+		writeJSON(out, results);
+	out.flush();
+
+	if(!baselinePath.empty() && compare(results, baselinePath, tolerance) > 0)
+		return 1;
+	return 0;
+}
@@ -1,241 +1,156 @@
 #include "LPSolver.hpp"
 
-#include <iostream>
+#include <array>
 
-using Eigen::Vector3d;
-using Eigen::Vector4d;
+//Largest core we look for constraints on
+#define MAX_CONSTRAINT_SIZE 10
 
-std::vector<double>& findConstraint_3(MatrixXd& subMat);
-std::vector<double>& findConstraint_4(MatrixXd& subMat);
-std::vector<double>& findConstraint_5(MatrixXd& subMat);
-std::vector<double>& findConstraint_6(MatrixXd& subMat);
-
-//Debugging info in case a constraint isn't found when it should be
-void fail_constraint(MatrixXd& subMat, const char* name, float bestDot);
-
-//Returns a constraint that the submatrix violates, or 0-length
-//if none is found.
-std::vector<double>& LPSolver::findConstraint(MatrixXd& subMat){
-	if(subMat.rows() == 3){
-		return findConstraint_3(subMat);
-	}
-	if(subMat.rows() == 4){
-		return findConstraint_4(subMat);
-	}
-	if(subMat.rows() == 5){
-		return findConstraint_5(subMat);
+//Every constraint found here is a hypermetric inequality: for an integer
+//vector b with an odd sum, any +-1 assignment s has (b.s)^2 >= 1, so
+//   sum_{i<j} b_i b_j x_ij >= (1 - sum b_i^2)/2.
+//Three +-1 entries give the triangle inequality, five the pentagonal one,
+//and zero entries "lift" a smaller inequality into a larger core.
+//For an N-row core we search the magnitude patterns ("shapes") of b:
+//every odd support of at least 3 rows with unit entries, and for even N
+//the full support with a single entry of 2 (e.g. the 6-row gap inequality).
+template<int N>
+constexpr int countShapes(){
+	int count = 0;
+	for(int mask=0; mask<(1<<N); mask++){
+		int k = 0;
+		for(int i=0;i<N;i++) k += (mask>>i) & 1;
+		if(k >= 3 && k%2 == 1) count++;
 	}
-	/*if(subMat.rows() == 6){
-		return findConstraint_6(subMat);
-	}*/
-	printf("Unhandled size %d, returning no constraint.\n", (int)subMat.rows());
-	return *new std::vector<double>;
+	if(N%2 == 0) count += N;
+	return count;
 }
 
-void fail_constraint(MatrixXd& subMat, const char* name, float bestDot){
-	std::cout << "Constraint finding assertion error!" << std::endl;
-	Eigen::SelfAdjointEigenSolver<MatrixXd> eig(subMat);
-	auto evals = eig.eigenvalues();
-	for(int i=0;i<evals.size();i++)
-		std::cout << evals[i] << std::endl;
-	std::cout << "Because" << std::endl;
-	std::cout << subMat << std::endl;
-	std::cout << "Constraint " << name << " ~ " << bestDot << std::endl;
-	exit(3);
-}
+template<int N>
+struct Shapes {
+	static constexpr int count = countShapes<N>();
+	std::array<std::array<int,N>,count> mag;
 
-std::vector<double>& findConstraint_3(MatrixXd& subMat){
-	Vector3d bestVec;
-	bestVec(0) = bestVec(1) = bestVec(2) = 1;
-	float bestDot = 0; //minimum 'useful' score of -1
-	for(int bits=0; bits<4; bits++){
-		Vector3d test;
-		test(0) = ((bits>>0) & 1)*2 - 1;
-		test(1) = ((bits>>1) & 1)*2 - 1;
-		test(2) = 1;
-		float score = test.transpose() * subMat * test;
-		score = (score - 3)/2;
-		if(score < bestDot){
-			bestDot = score;
-			bestVec = test;
+	constexpr Shapes() : mag() {
+		int s = 0;
+		for(int mask=0; mask<(1<<N); mask++){
+			int k = 0;
+			for(int i=0;i<N;i++) k += (mask>>i) & 1;
+			if(k < 3 || k%2 == 0) continue;
+			for(int i=0;i<N;i++) mag[s][i] = (mask>>i) & 1;
+			s++;
 		}
-	}
-	std::vector<double>& res = *new std::vector<double>(4);
-	res[1] = bestVec(0)*bestVec(1);
-	res[2] = bestVec(0)*bestVec(2);
-	res[3] = bestVec(1)*bestVec(2);
-	res[0] = -1;
-	
-	if(bestDot >= -1)
-		fail_constraint(subMat, "3", bestDot);
-	return res;
-}
-
-std::vector<double>& findConstraint_4(MatrixXd& subMat){
-	Vector4d bestVec; 
-	bestVec(0) = bestVec(1) = bestVec(2) = bestVec(3) = 1;
-	float bestDot = 0; //minimum 'useful' score of -1
-	for(int dir=0; dir<4; dir++){
-			for(int bits=0; bits<4; bits++){
-			Vector4d test;
-			test(0) = ((bits>>0) & 1)*2 - 1;
-			test(1) = ((bits>>1) & 1)*2 - 1;
-			test(2) = 1;
-			test(3) = 0;
-			
-			float temp = test(dir);
-			test(dir) = test(3);
-			test(3) = temp;
-			
-			float score = test.transpose() * subMat * test;
-			score = (score - 3)/2;
-			if(score < bestDot){
-				bestDot = score;
-				bestVec = test;
+		if(N%2 == 0){
+			for(int two=0; two<N; two++){
+				for(int i=0;i<N;i++) mag[s][i] = (i == two ? 2 : 1);
+				s++;
 			}
 		}
 	}
-	std::vector<double>& res = *new std::vector<double>(7);
-	res[1] = bestVec(1)*bestVec(0);
-	res[2] = bestVec(2)*bestVec(0);
-	res[3] = bestVec(2)*bestVec(1);
-	res[4] = bestVec(3)*bestVec(0);
-	res[5] = bestVec(3)*bestVec(1);
-	res[6] = bestVec(3)*bestVec(2);
-	res[0] = -1;
-	
-	if(bestDot >= -1)
-		fail_constraint(subMat, "4", bestDot);
-	return res;
-}
+};
 
-std::vector<double>& findConstraint_5(MatrixXd& subMat){
-	VectorXd bestVec(5); 
-	bestVec(0) = bestVec(1) = bestVec(2) = bestVec(3) = bestVec(4) = 1;
-	float bestDot = 0; //minimum 'useful' score of -2
-	for(int dir=0; dir<5; dir++){
-		for(int dir2=dir+1; dir2<5; dir2++){
-			for(int bits=0; bits<4; bits++){
-				VectorXd test(5);
-				
-				test(0) = ((bits>>0) & 1)*2 - 1;
-				test(1) = ((bits>>1) & 1)*2 - 1;
-				test(2) = 1;
-				test(3) = 0;
-				test(4) = 0;
-				
-				{float temp = test(dir);
-				test(dir) = test(3);
-				test(3) = temp;}
-				
-				
-				{float temp = test(dir2);
-				test(dir2) = test(4);
-				test(4) = temp;}
-				
-				float score = test.transpose() * subMat * test;
-				score = (score - 3)/2;
-				if(score < bestDot){
-					bestDot = score;
-					bestVec = test;
-				}
-			}
+//Finds the most violated hypermetric inequality on an N-row core. The
+//result holds the right side in [0], then the coefficients in the
+//PairIndex order of the core: (1,0), (2,0), (2,1), (3,0), ...
+//Returns how far it is violated; if that is <= 0, nothing is, and res is
+//left alone.
+template<int N>
+double findConstraint(const Eigen::Matrix<double,N,N>& subMat, std::array<double, 1+N*(N-1)/2>& res){
+	static constexpr Shapes<N> shapes{};
+
+	Eigen::Matrix<double,N,1> bestVec, test;
+	double bestRight = 0, bestViolation = 0;
+
+	for(int s=0; s<shapes.count; s++){
+		const std::array<int,N>& mag = shapes.mag[s];
+
+		int support[N], k = 0, norm2 = 0;
+		for(int i=0;i<N;i++){
+			if(mag[i] != 0) support[k++] = i;
+			norm2 += mag[i]*mag[i];
 		}
-	}
-	std::vector<double>& res = *new std::vector<double>(11);
-	res[0] = -1;
-	
-	if(bestDot > -1){
-		//It's option two: the non-lifted 3 constraint
-		bestDot = 0; //minimum 'useful' score of -1
-		
-		for(int bits=0; bits<16; bits++){
-			VectorXd test(5);
-			test(0) = ((bits>>0) & 1)*2 - 1;
-			test(1) = ((bits>>1) & 1)*2 - 1;
-			test(2) = ((bits>>2) & 1)*2 - 1;
-			test(3) = ((bits>>3) & 1)*2 - 1;
-			test(4) = 1;
-			
-			float score = test.transpose() * subMat * test;
-			score = (score - 5)/2; //this line shouldn't be uncommented ... but leaving it out
-			//(a bug) makes stuff run faster, but definitely still correctly. Understand why!
-			if(score < bestDot){
-				bestDot = score;
+		double rightSide = (1 - norm2)/2.;
+
+		//b and -b give the same inequality, so fix the first sign and walk
+		//the other signs in Gray code order. Flipping b_p changes the left
+		//side by -2 b_p r_p, where r_p = sum_{j!=p} b_j x_pj; keeping r up
+		//to date makes each step O(N) instead of a full quadratic form.
+		test.setZero();
+		for(int t=0;t<k;t++) test(support[t]) = mag[support[t]];
+		Eigen::Matrix<double,N,1> r = subMat*test - subMat.diagonal().cwiseProduct(test);
+		double score = test.dot(r)/2;
+
+		for(int step=0; ; step++){
+			if(rightSide - score > bestViolation){
+				bestViolation = rightSide - score;
+				bestRight = rightSide;
 				bestVec = test;
 			}
+			if(step+1 == (1<<(k-1))) break;
+
+			int p = support[1 + __builtin_ctz(step+1)];
+			double bOld = test(p);
+			score -= 2*bOld*r(p);
+			r -= 2*bOld*subMat.col(p);
+			r(p) += 2*bOld*subMat(p,p); //the diagonal isn't part of r
+			test(p) = -bOld;
 		}
-		res[0] = -2;
-	
-		if(bestDot >= -2)
-			fail_constraint(subMat, "5", bestDot);
 	}
-	
-	res[1] = bestVec(1)*bestVec(0);
-	res[2] = bestVec(2)*bestVec(0);
-	res[3] = bestVec(2)*bestVec(1);
-	res[4] = bestVec(3)*bestVec(0);
-	res[5] = bestVec(3)*bestVec(1);
-	res[6] = bestVec(3)*bestVec(2);
-	res[7] = bestVec(4)*bestVec(0);
-	res[8] = bestVec(4)*bestVec(1);
-	res[9] = bestVec(4)*bestVec(2);
-	res[10] = bestVec(4)*bestVec(3);
-	return res;
+
+	if(bestViolation <= 0)
+		return bestViolation;
+
+	res[0] = bestRight;
+	int v = 1;
+	for(int x=1;x<N;x++)
+		for(int y=0;y<x;y++)
+			res[v++] = bestVec(x)*bestVec(y);
+	return bestViolation;
 }
 
-std::vector<double>& findConstraint_6(MatrixXd& subMat){
-	VectorXd bestVec(6); 
-	bestVec(0) = bestVec(1) = bestVec(2) = bestVec(3) = bestVec(4) = bestVec(5) = 1;
-	float bestDot = -4; //minimum 'useful' score of -4
-	
-	for(int dir=0; dir<6; dir++){
-		for(int bits=0; bits<32; bits++){
-			VectorXd test(6);
-			test(0) = ((bits>>0) & 1)*2 - 1;
-			test(1) = ((bits>>1) & 1)*2 - 1;
-			test(2) = ((bits>>2) & 1)*2 - 1;
-			test(3) = ((bits>>3) & 1)*2 - 1;
-			test(4) = ((bits>>4) & 1)*2 - 1;
-			test(5) = 2;
-			
-			float temp = test(dir);
-			test(dir) = test(5);
-			test(5) = temp;
-			
-			float score = test.transpose() * subMat * test;
-			score = (score - 9) / 2;
-			if(score < bestDot){
-				bestDot = score;
-				bestVec = test;
-			}
-		}
-	}
-	
-	if(bestDot < -4){
-		//std::cout << "Constraint HP6!! :) ~ " << bestDot << std::endl;
-	} else {
-		//std::cout << "Constraint 6 NOT FOUND :( ~ " << bestDot << std::endl;
-		return *new std::vector<double>(0);
+//Copies into and out of the fixed-size kernel, so that all the
+//enumeration happens on stack-allocated, unrollable types. Returns the
+//violation of the most violated inequality, which is only written into
+//'constraint' if it is more than minViolation.
+template<int N>
+static double findConstraintSized(const MatrixXd& subMat, std::vector<double>& constraint, double minViolation){
+	Eigen::Matrix<double,N,N> fixedMat = subMat;
+	std::array<double, 1+N*(N-1)/2> res;
+
+	double violation = findConstraint<N>(fixedMat, res);
+	if(violation > minViolation)
+		constraint.assign(res.begin(), res.end());
+	return violation;
+}
+
+typedef double (*ConstraintKernel)(const MatrixXd& subMat, std::vector<double>& constraint, double minViolation);
+
+static const ConstraintKernel constraintKernels[MAX_CONSTRAINT_SIZE+1] = {
+	NULL, NULL, NULL,
+	findConstraintSized<3>,
+	findConstraintSized<4>,
+	findConstraintSized<5>,
+	findConstraintSized<6>,
+	findConstraintSized<7>,
+	findConstraintSized<8>,
+	findConstraintSized<9>,
+	findConstraintSized<10>,
+};
+
+//Writes a constraint that the submatrix violates by more than
+//config.minCutViolation into 'constraint' and returns true, or returns
+//false if none is found.
+bool LPSolver::findConstraint(const MatrixXd& subMat, std::vector<double>& constraint){
+	uint32_t size = subMat.rows();
+	if(size > MAX_CONSTRAINT_SIZE || constraintKernels[size] == NULL){
+		printf("Unhandled size %d, returning no constraint.\n", (int)size);
+		return false;
 	}
-	
-	std::vector<double>& res = *new std::vector<double>(1 + 6*5/2);
-	
-	res[0] = -4;
-	res[1] = bestVec(1)*bestVec(0);
-	res[2] = bestVec(2)*bestVec(0);
-	res[3] = bestVec(2)*bestVec(1);
-	res[4] = bestVec(3)*bestVec(0);
-	res[5] = bestVec(3)*bestVec(1);
-	res[6] = bestVec(3)*bestVec(2);
-	res[7] = bestVec(4)*bestVec(0);
-	res[8] = bestVec(4)*bestVec(1);
-	res[9] = bestVec(4)*bestVec(2);
-	res[10] = bestVec(4)*bestVec(3);
-	res[11] = bestVec(5)*bestVec(0);
-	res[12] = bestVec(5)*bestVec(1);
-	res[13] = bestVec(5)*bestVec(2);
-	res[14] = bestVec(5)*bestVec(3);
-	res[15] = bestVec(5)*bestVec(4);
-	return res;
-}
\ No newline at end of file
+
+	double violation = constraintKernels[size](subMat, constraint, config.minCutViolation);
+	//Up to 5 rows, hypermetric inequalities describe the whole cut
+	//polytope, so a non-PSD core must violate one of them; if none is,
+	//the core was only non-PSD by rounding. Count it and move on.
+	if(violation <= 0 && size <= 5)
+		metrics.count(COUNT_CORE_MISSES);
+	return violation > config.minCutViolation;
+}
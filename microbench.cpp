@@ -0,0 +1,263 @@
+#include "Problem.hpp"
+#include "LPSolver.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+
+//Times the solver's hot kernels one at a time on synthetic LP solutions,
+//reporting ns/op and heap allocations/op.
+//
+//Usage: microbench [--filter SUBSTRING] [--min-time SECONDS] [--n VARIABLES]
+//                  [--lp ENGINE]
+//
+//--lp picks the engine the lp/ kernels run on, as in bench.
+
+//Count every heap allocation in the process by wrapping glibc's malloc.
+//operator new and Eigen's allocator both end up here, so the count is exact.
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* p, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* p);
+}
+
+static std::atomic<uint64_t> allocations(0);
+
+extern "C" {
+void* malloc(size_t size){
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	return __libc_malloc(size);
+}
+void* calloc(size_t n, size_t size){
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	return __libc_calloc(n, size);
+}
+void* realloc(void* p, size_t size){
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	return __libc_realloc(p, size);
+}
+void* memalign(size_t alignment, size_t size){
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	return __libc_memalign(alignment, size);
+}
+void* aligned_alloc(size_t alignment, size_t size){
+	return memalign(alignment, size);
+}
+int posix_memalign(void** p, size_t alignment, size_t size){
+	*p = memalign(alignment, size);
+	return *p ? 0 : ENOMEM;
+}
+void free(void* p){
+	__libc_free(p);
+}
+}
+
+//Exposes the protected kernels, and lets the LP solution be set directly
+class KernelHarness : public LPSolver
+{
+ public:
+	KernelHarness(Problem* p, const LPSolverConfig& config) : LPSolver(p, config) {}
+
+	//Make the LP solution from a random assignment v, with every pair on the
+	//same side pulled from 1 down to 1-2t. t = 0 is the assignment itself,
+	//so PSD and satisfying every cut. For t > 0, rows i,j on one side and k
+	//on the other violate x_ij + x_ik + x_jk >= -1 by 2t. v_0 and v_1 differ,
+	//so any core holding rows 0, 1 and one more has a violated triangle.
+	void setSolution(double t, uint64_t seed){
+		Rng rng(seed);
+		std::vector<int> v(nQP);
+		for(uint32_t i=0;i<nQP;i++) v[i] = (rng() & 1) ? 1 : -1;
+		v[0] = 1;
+		v[1] = -1;
+		for(uint32_t i=1;i<nQP;i++)
+			for(uint32_t j=0;j<i;j++)
+				currSol[pairs.index(i,j)-1] = (1-t)*v[i]*v[j] - t;
+		cacheSolution();
+	}
+
+	using LPSolver::nonPSDcore;
+	using LPSolver::isPSD;
+	using LPSolver::isPSDIn;
+	using LPSolver::getSubmatrix;
+	using LPSolver::findConstraint;
+	using LPSolver::scoreRelaxation;
+	using LPSolver::cacheSolution;
+	using LPSolver::workspace;
+	using LPSolver::lp;
+	using LPSolver::nQP;
+	using LPSolver::nLP;
+};
+
+struct Measurement {
+	double nsPerOp;
+	double allocsPerOp;
+};
+
+//Run 'op' in batches until minTime has passed, five times, and take the
+//fastest; allocations are counted over all of them
+static Measurement measure(const std::function<void()>& op, double minTime){
+	typedef std::chrono::steady_clock clock;
+	op(); //warm up caches and the workspace
+
+	double best = 1e300;
+	uint64_t totalOps = 0, totalAllocs = 0;
+	for(int rep=0;rep<5;rep++){
+		uint64_t ops = 0, batch = 1;
+		uint64_t allocsBefore = allocations.load();
+		clock::time_point start = clock::now();
+		double elapsed;
+		do {
+			for(uint64_t i=0;i<batch;i++) op();
+			ops += batch;
+			batch *= 2;
+			elapsed = std::chrono::duration<double>(clock::now() - start).count();
+		} while(elapsed < minTime/5);
+		totalAllocs += allocations.load() - allocsBefore;
+		totalOps += ops;
+		best = std::min(best, elapsed*1e9/ops);
+	}
+	return {best, (double)totalAllocs/totalOps};
+}
+
+static Problem* randomMax2SAT(uint32_t n, uint64_t seed){
+	Rng rng(seed);
+	std::vector<clause2> clauses;
+	for(uint32_t i=0;i<4*n;i++){
+		int a = 1 + rng.below(n), b;
+		do b = 1 + rng.below(n); while(b == a);
+		clauses.push_back(clause2(1, (rng() & 1) ? a : -a, (rng() & 1) ? b : -b));
+	}
+	return Problem::from2SAT(n, clauses, std::vector<double>(n, 0));
+}
+
+int main(int argc, char** argv){
+	std::string filter;
+	double minTime = 0.5;
+	uint32_t n = 60;
+	LPSolverConfig config;
+	config.verbose = false;
+	for(int i=1;i<argc;i++){
+		std::string arg = argv[i];
+		if(arg == "--filter" && i+1 < argc) filter = argv[++i];
+		else if(arg == "--min-time" && i+1 < argc) minTime = atof(argv[++i]);
+		else if(arg == "--n" && i+1 < argc) n = atoi(argv[++i]);
+		else if(arg == "--lp" && i+1 < argc && lpEngineFromName(argv[i+1], config.lpEngine)) i++;
+		else {
+			fprintf(stderr, "Usage: %s [--filter SUBSTRING] [--min-time SECONDS] [--n VARIABLES] [--lp ENGINE]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	Problem* p = randomMax2SAT(n, 1);
+	KernelHarness h(p, config);
+
+	printf("%-32s %14s %12s\n", "kernel", "ns/op", "allocs/op");
+	auto run = [&](const std::string& name, const std::function<void()>& op){
+		if(!filter.empty() && name.find(filter) == std::string::npos) return;
+		Measurement m = measure(op, minTime);
+		printf("%-32s %14.1f %12.2f\n", name.c_str(), m.nsPerOp, m.allocsPerOp);
+		fflush(stdout);
+	};
+
+	std::vector<uint32_t> banned, core;
+	std::vector<double> constraint;
+	char name[64];
+
+	//Violation levels: none (a full PSD scan), slight, and strong;
+	//screened in float (the default) and in double throughout
+	for(bool floatScreen : {true, false}){
+		h.config.floatScreen = floatScreen;
+		for(double t : {0.0, 0.02, 0.3}){
+			h.setSolution(t, 2);
+			snprintf(name, sizeof(name), "nonPSDcore/%s/t=%g", floatScreen ? "float" : "double", t);
+			run(name, [&]{ h.nonPSDcore(banned, core); });
+		}
+	}
+	h.config.floatScreen = true;
+
+	h.setSolution(0.3, 2);
+	for(uint32_t k : {3, 5, 10, 30}){
+		if(k > h.nQP) continue;
+		std::vector<uint32_t> rows(k);
+		for(uint32_t i=0;i<k;i++) rows[i] = (i*7) % h.nQP;
+		std::sort(rows.begin(), rows.end());
+		rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+		MatrixXd& sub = h.workspace.matrix(rows.size());
+		snprintf(name, sizeof(name), "getSubmatrix/k=%u", (uint32_t)rows.size());
+		run(name, [&]{ h.getSubmatrix(rows, sub); });
+		snprintf(name, sizeof(name), "isPSD/k=%u", (uint32_t)rows.size());
+		run(name, [&]{ h.isPSD(rows); });
+		snprintf(name, sizeof(name), "isPSD/float/k=%u", (uint32_t)rows.size());
+		run(name, [&]{ h.isPSDIn<ScreenReal>(rows); });
+	}
+
+	//Barely and strongly violated cores
+	for(uint32_t k=3;k<=10 && k<=h.nQP;k++){
+		std::vector<uint32_t> rows(k);
+		for(uint32_t i=0;i<k;i++) rows[i] = i;
+		for(double t : {0.02, 0.3}){
+			h.setSolution(t, 3);
+			MatrixXd sub(k, k);
+			h.getSubmatrix(rows, sub);
+			snprintf(name, sizeof(name), "findConstraint/k=%u/t=%g", k, t);
+			run(name, [&]{ h.findConstraint(sub, constraint); });
+		}
+	}
+
+	h.setSolution(0.3, 2);
+	run("cacheSolution", [&]{ h.cacheSolution(); });
+	run("scoreRelaxation", [&]{ h.scoreRelaxation(); });
+
+	VectorXd assignment(h.nQP);
+	for(uint32_t i=0;i<h.nQP;i++) assignment(i) = (i % 3) ? 1 : -1;
+	run("Problem::score", [&]{ p->score(assignment); });
+
+	//Warm-started re-solve after nudging one objective coefficient, which is
+	//what each round costs the LP once its basis is known. A few rounds of
+	//the solver first give the LP a realistic set of cuts.
+	if(filter.empty() || std::string("lp/resolve").find(filter) != std::string::npos
+		|| std::string("lp/cuts").find(filter) != std::string::npos){
+		h.config.maxRounds = 5;
+		h.solve();
+		h.lp->solve();
+		double c1 = h.lp->objective(1);
+		bool flip = false;
+		run("lp/resolve", [&]{
+			h.lp->setObjective(1, flip ? c1 : c1 + 0.5);
+			flip = !flip;
+			h.lp->solve();
+		});
+
+		//The other part of a round: the newest cuts removed and added back,
+		//with a solve after each
+		const uint32_t CUTS = 10;
+		uint32_t rows = h.lp->numRows();
+		if(rows >= CUTS){
+			std::vector<std::vector<int>> indices(CUTS, std::vector<int>(h.nLP+1));
+			std::vector<std::vector<double>> values(CUTS, std::vector<double>(h.nLP+1));
+			std::vector<uint32_t> lengths(CUTS);
+			std::vector<double> rightSides(CUTS);
+			std::vector<int> doomed(1);
+			for(uint32_t k=0;k<CUTS;k++){
+				lengths[k] = h.lp->getRow(rows-CUTS+1+k, &indices[k][0], &values[k][0], rightSides[k]);
+				doomed.push_back(rows-CUTS+1+k);
+			}
+			run("lp/cuts", [&]{
+				h.lp->deleteRows(CUTS, &doomed[0]);
+				h.lp->solve();
+				for(uint32_t k=0;k<CUTS;k++)
+					h.lp->addRow(lengths[k], &indices[k][0], &values[k][0], rightSides[k]);
+				h.lp->solve();
+			});
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,113 @@
+#include "LPSolver.hpp"
+
+#include <algorithm>
+#include <set>
+
+//A hypermetric vector b found by the greedy search, and how far the LP
+//solution violates its inequality
+typedef struct {
+	std::vector<std::pair<uint32_t,int>> entries; //(row, b_row), rows ascending
+	double violation;
+} hypermetric;
+
+//Greedy search for violated hypermetric inequalities
+//   sum_{i<j} b_i b_j x_ij >= (1 - sum b_i^2)/2,   sum b_i odd,
+//written with the unit diagonal as b^T X b >= 1. Starting from b = e_seed,
+//repeatedly add +-1 to the entry of b that lowers b^T X b the most; adding
+//s*e_j changes it by 2s(Xb)_j + 1, so keeping y = Xb makes each step O(n).
+//Every odd-sum b along the way is a candidate. With maxCoeff = 1 the
+//entries stay in {-1,0,1} and the candidates are (2q+1)-clique inequalities.
+static void greedyHypermetric(const MatrixXd& X, uint32_t seed, int maxCoeff, uint32_t maxSupport, double minViolation, hypermetric& best){
+	uint32_t n = X.rows();
+	std::vector<int> b(n, 0);
+	VectorXd y = X.col(seed);
+	double bXb = 1;
+	int sum = 1;
+	uint32_t support = 1;
+	b[seed] = 1;
+
+	std::vector<int> bestB;
+	best.violation = minViolation;
+
+	for(uint32_t step=1; step<maxCoeff*maxSupport; step++){
+		//only grow |b_j|, so the search can't cycle
+		int bestJ = -1, bestS = 0;
+		double bestDelta = 0;
+		for(uint32_t j=0;j<n;j++){
+			int s = y(j) > 0 ? -1 : 1;
+			if(b[j]*s < 0 || abs(b[j]) >= maxCoeff) continue;
+			if(b[j] == 0 && support >= maxSupport) continue;
+			double delta = 2*s*y(j) + X(j,j);
+			if(bestJ < 0 || delta < bestDelta){
+				bestJ = j;
+				bestS = s;
+				bestDelta = delta;
+			}
+		}
+		if(bestJ < 0) break;
+
+		if(b[bestJ] == 0) support++;
+		b[bestJ] += bestS;
+		sum += bestS;
+		bXb += bestDelta;
+		y += bestS * X.col(bestJ);
+
+		if(sum % 2 != 0 && support >= 3 && 1 - bXb > best.violation){
+			best.violation = 1 - bXb;
+			bestB = b;
+		}
+	}
+
+	best.entries.clear();
+	for(uint32_t j=0;j<bestB.size();j++)
+		if(bestB[j] != 0) best.entries.push_back({j, bestB[j]});
+}
+
+//Look for violated (2q+1)-clique and general hypermetric inequalities
+//directly from currSol, seeding the greedy search at every row. Adds the
+//most violated distinct ones not already in the LP (up to
+//config.hypermetricMaxCuts), and returns how many were added.
+uint32_t LPSolver::separateHypermetric(){
+	const MatrixXd& X = solMat;
+
+	std::vector<hypermetric> found;
+	std::set<std::vector<std::pair<uint32_t,int>>> seen;
+	hypermetric candidate;
+	for(uint32_t seed=0; seed<nQP; seed++){
+		for(int maxCoeff=1; maxCoeff<=2; maxCoeff++){
+			greedyHypermetric(X, seed, maxCoeff, config.hypermetricMaxSupport, config.minCutViolation, candidate);
+			if(candidate.entries.empty()) continue;
+
+			//b and -b are the same inequality
+			if(candidate.entries[0].second < 0)
+				for(auto& e : candidate.entries) e.second = -e.second;
+			if(seen.insert(candidate.entries).second)
+				found.push_back(candidate);
+		}
+	}
+
+	std::sort(found.begin(), found.end(), [](const hypermetric& a, const hypermetric& b){
+		return a.violation > b.violation;
+	});
+
+	uint32_t added = 0;
+	std::vector<int> indices;
+	std::vector<double> values;
+	for(auto& h : found){
+		if(added >= config.hypermetricMaxCuts) break;
+		//sum_{i<j} b_i b_j x_ij >= (1 - sum b_i^2)/2
+		indices.assign(1, 0);
+		values.assign(1, 0);
+		int norm2 = 0;
+		for(uint32_t a=0;a<h.entries.size();a++){
+			norm2 += h.entries[a].second*h.entries[a].second;
+			for(uint32_t c=a+1;c<h.entries.size();c++){
+				indices.push_back(pairs(h.entries[a].first, h.entries[c].first));
+				values.push_back(h.entries[a].second*h.entries[c].second);
+			}
+		}
+		added += addConstraint(indices.size()-1, &indices[0], &values[0], (1 - norm2)/2.);
+	}
+
+	return added;
+}
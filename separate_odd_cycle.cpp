@@ -0,0 +1,198 @@
+#include "LPSolver.hpp"
+
+#include <algorithm>
+#include <queue>
+#include <set>
+#include <limits>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+//Odd-cycle inequalities: for a cycle C and an odd subset F of its edges,
+//every +-1 assignment has
+//   sum_{e in F} x_e - sum_{e in C\F} x_e >= 2 - |C|,
+//which is violated exactly when
+//   sum_{e in F} (1+x_e)/2 + sum_{e in C\F} (1-x_e)/2 < 1.
+//So they separate exactly as shortest paths in the doubled graph with
+//nodes (v, parity): an edge uv joins (u,p)-(v,p) at cost (1-x_uv)/2 and
+//(u,p)-(v,1-p) at cost (1+x_uv)/2, and a path (s,0) -> (s,1) shorter than
+//1 is a violated odd closed walk through s. Triangle inequalities are the
+//|C| = 3 case.
+
+//An odd cycle found from one source: vertices in order, and whether each
+//edge (cycle[t], cycle[t+1 mod |C|]) is in F
+typedef struct {
+	std::vector<uint32_t> cycle;
+	std::vector<bool> odd;
+	double weight;
+} oddCycle;
+
+//Split a closed walk at repeated vertices, keeping an odd part each time,
+//until it is a simple cycle. Costs are nonnegative, so the part kept is no
+//heavier than the walk and is still violated.
+static void simplifyWalk(oddCycle& walk, std::vector<int>& position){
+	while(true){
+		uint32_t k = walk.cycle.size();
+		int a = -1, b = -1;
+		for(uint32_t t=0;t<k;t++){
+			uint32_t v = walk.cycle[t];
+			if(position[v] >= 0){
+				a = position[v];
+				b = t;
+				break;
+			}
+			position[v] = t;
+		}
+		for(uint32_t t=0;t<k;t++) position[walk.cycle[t]] = -1;
+		if(a < 0) return;
+
+		//edges a..b-1 form one closed walk, the rest the other
+		uint32_t parity = 0;
+		for(int t=a;t<b;t++) parity += walk.odd[t];
+
+		oddCycle part;
+		if(parity % 2 == 1){
+			part.cycle.assign(walk.cycle.begin()+a, walk.cycle.begin()+b);
+			part.odd.assign(walk.odd.begin()+a, walk.odd.begin()+b);
+		} else {
+			part.cycle.assign(walk.cycle.begin()+b, walk.cycle.end());
+			part.cycle.insert(part.cycle.end(), walk.cycle.begin(), walk.cycle.begin()+a);
+			part.odd.assign(walk.odd.begin()+b, walk.odd.end());
+			part.odd.insert(part.odd.end(), walk.odd.begin(), walk.odd.begin()+a);
+		}
+		walk.cycle.swap(part.cycle);
+		walk.odd.swap(part.odd);
+	}
+}
+
+//Look for violated odd-cycle inequalities on the support graph of the
+//problem, running Dijkstra from every vertex in parallel. Adds the most
+//violated distinct ones not already in the LP (up to
+//config.oddCycleMaxCuts), and returns how many were added.
+uint32_t LPSolver::separateOddCycles(){
+	if(support.numEdges() == 0) return 0;
+
+	//per-edge costs, indexed like support.adj
+	std::vector<double> evenCost(support.adj.size()), oddCost(support.adj.size());
+	for(uint32_t u=0;u<nQP;u++){
+		for(size_t a=support.offsets[u];a<support.offsets[u+1];a++){
+			double x = currSol[pairs(u, support.adj[a])-1];
+			evenCost[a] = std::max(0., (1-x)/2);
+			oddCost[a] = std::max(0., (1+x)/2);
+		}
+	}
+
+	double cutoff = 1 - config.minCutViolation/2;
+	//At most one cycle per source, kept by source so that the order they
+	//are considered in below doesn't depend on the threads
+	std::vector<oddCycle> found(nQP);
+
+	int threads = config.threads;
+#ifdef _OPENMP
+	if(threads == 0) threads = omp_get_max_threads();
+#endif
+	#pragma omp parallel num_threads(threads)
+	{
+		ScopedTrace trace(config.trace, "odd_cycle_worker");
+		std::vector<double> dist(2*nQP, std::numeric_limits<double>::infinity());
+		std::vector<int> pred(2*nQP, -1);
+		std::vector<uint32_t> touched;
+		std::vector<int> position(nQP, -1);
+		typedef std::pair<double,uint32_t> entry;
+
+		#pragma omp for schedule(dynamic, 8)
+		for(uint32_t s=0;s<nQP;s++){
+			//Dijkstra from (s,0), only out to distance 'cutoff'
+			std::priority_queue<entry, std::vector<entry>, std::greater<entry>> heap;
+			uint32_t target = 2*s+1;
+			dist[2*s] = 0;
+			touched.push_back(2*s);
+			heap.push({0, 2*s});
+			while(!heap.empty()){
+				entry top = heap.top();
+				heap.pop();
+				uint32_t node = top.second;
+				if(top.first > dist[node]) continue;
+				if(node == target) break;
+
+				uint32_t u = node/2, p = node%2;
+				for(size_t a=support.offsets[u];a<support.offsets[u+1];a++){
+					uint32_t v = support.adj[a];
+					uint32_t nodes[2] = {2*v+p, 2*v+(1-p)};
+					double costs[2] = {evenCost[a], oddCost[a]};
+					for(int o=0;o<2;o++){
+						double d = top.first + costs[o];
+						if(d < cutoff && d < dist[nodes[o]]){
+							if(dist[nodes[o]] == std::numeric_limits<double>::infinity())
+								touched.push_back(nodes[o]);
+							dist[nodes[o]] = d;
+							pred[nodes[o]] = node;
+							heap.push({d, nodes[o]});
+						}
+					}
+				}
+			}
+
+			if(dist[target] < cutoff){
+				//walk back (s,1) -> (s,0); parity changes mark odd edges
+				oddCycle walk;
+				walk.weight = dist[target];
+				for(uint32_t node = target; node != 2*s; node = pred[node]){
+					uint32_t prev = pred[node];
+					walk.cycle.push_back(node/2);
+					walk.odd.push_back(prev%2 != node%2);
+				}
+				simplifyWalk(walk, position);
+				if(walk.cycle.size() >= 3)
+					found[s] = std::move(walk);
+			}
+
+			for(uint32_t node : touched){
+				dist[node] = std::numeric_limits<double>::infinity();
+				pred[node] = -1;
+			}
+			touched.clear();
+		}
+	}
+
+	//recompute each cycle's cost, keep the violated, distinct ones
+	std::set<std::vector<std::pair<uint32_t,uint32_t>>> seen;
+	std::vector<oddCycle> cuts;
+	for(auto& c : found){
+		uint32_t k = c.cycle.size();
+		if(k == 0) continue;
+		std::vector<std::pair<uint32_t,uint32_t>> key;
+		c.weight = 0;
+		for(uint32_t t=0;t<k;t++){
+			uint32_t u = c.cycle[t], v = c.cycle[(t+1)%k];
+			double x = currSol[pairs(u, v)-1];
+			c.weight += c.odd[t] ? (1+x)/2 : (1-x)/2;
+			key.push_back({std::min(u,v)*2 + c.odd[t], std::max(u,v)});
+		}
+		std::sort(key.begin(), key.end());
+		if(c.weight < cutoff && seen.insert(key).second)
+			cuts.push_back(c);
+	}
+	//Stable, so ties stay in source order
+	std::stable_sort(cuts.begin(), cuts.end(), [](const oddCycle& a, const oddCycle& b){
+		return a.weight < b.weight;
+	});
+
+	uint32_t added = 0;
+	std::vector<int> indices;
+	std::vector<double> values;
+	for(auto& c : cuts){
+		if(added >= config.oddCycleMaxCuts) break;
+		//sum_F x_e - sum_{C\F} x_e >= 2 - |C|
+		uint32_t k = c.cycle.size();
+		indices.assign(1, 0);
+		values.assign(1, 0);
+		for(uint32_t t=0;t<k;t++){
+			indices.push_back(pairs(c.cycle[t], c.cycle[(t+1)%k]));
+			values.push_back(c.odd[t] ? 1 : -1);
+		}
+		added += addConstraint(k, &indices[0], &values[0], 2. - k);
+	}
+
+	return added;
+}
@@ -1,34 +1,57 @@
 #include "Problem.hpp"
+#include "DecomposedSolver.hpp"
+#include "Presolve.hpp"
 #include "LPSolver.hpp"
 
 #include <iostream>
-#include <random>
-#include <chrono>
 #include <cmath>
+#include <string.h>
+#include <stdexcept>
+#include <memory>
+#include <set>
 
-void setSampleProblem(uint32_t& variables, std::vector<clause3>& clause3s, std::vector<clause2>& clauses, std::vector<float>& literalWeights);
+void setSampleProblem(uint32_t& variables, std::vector<clause3>& clause3s, std::vector<clause2>& clauses, std::vector<double>& literalWeights);
+bool runChecks();
 
-int main(){
+//Usage: test [trace.json]
+//       test --check (run the regression checks; exit status 1 if any fails)
+int main(int argc, char** argv){
+	if(argc > 1 && !strcmp(argv[1], "--check")){
+		return runChecks() ? 0 : 1;
+	}
+	
 	uint32_t variables;
 	 //Each term is <(v1,v2), weight>, representing v1 OR v2.
 	std::vector<clause3> clause3s;
 	std::vector<clause2> clause2s;
-	std::vector<float> literalWeights;
+	std::vector<double> literalWeights;
 	setSampleProblem(variables, clause3s, clause2s, literalWeights);
 	
 	Problem* p = Problem::from3SAT(variables, clause3s, clause2s, literalWeights);
-	LPSolver solver = LPSolver(p);
+	Presolve presolve(*p);
+	std::cout << "Presolve fixed " << presolve.numFixed() << " of " << p->nQP-1 << " variables (" << presolve.fixedByDominance << " by dominance, " << presolve.fixedByRoofDuality << " by roof duality)" << std::endl;
+	
+	LPSolverConfig config;
+	TraceRecorder trace;
+	if(argc > 1)
+		config.trace = &trace;
+	
+	DecomposedSolver solver(presolve.reduced, config);
 	solver.solve();
+	printf("Score on the original problem = %f\n", p->score(presolve.expand(solver.bestSol)));
+	
+	if(argc > 1 && !trace.write(argv[1]))
+		std::cerr << "Could not write trace to " << argv[1] << std::endl;
 }
 
-void setSampleProblem(uint32_t& variables, std::vector<clause3>& clause3s, std::vector<clause2>& clause2s, std::vector<float>& literalWeights){
+void setSampleProblem(uint32_t& variables, std::vector<clause3>& clause3s, std::vector<clause2>& clause2s, std::vector<double>& literalWeights){
 	variables = 48;
 	literalWeights.resize(variables);
 	
 	std::vector<int> realSol;
-	std::default_random_engine generator(1234+std::chrono::high_resolution_clock::now().time_since_epoch().count()*0);
-	std::uniform_int_distribution<int> truthGenerator(0,1);
-	std::uniform_int_distribution<int> variableChoser(1,variables);
+	Rng generator(1234);
+	auto truthGenerator = [](Rng& g){ return (int)g.below(2); };
+	auto variableChoser = [&](Rng& g){ return 1 + (int)g.below(variables); };
 	std::cout << "True satisfaction: " << std::endl;
 	for(uint32_t i=0;i<variables;i++){
 		realSol.push_back(2*truthGenerator(generator) - 1);
@@ -48,7 +71,7 @@ void setSampleProblem(uint32_t& variables, std::vector<clause3>& clause3s, std::
 		varA *= realSol[varA-1];
 		varB *= realSol[varB-1];
 		//std::cout << "Clause " << varA << ", " << varB << std::endl;
-		float weight = w1 ? 1 : (variables+variableChoser(generator))*variableChoser(generator)*0.1;
+		double weight = w1 ? 1 : (variables+variableChoser(generator))*variableChoser(generator)*0.1;
 		clause2s.push_back({weight, varA, varB});
 	}
 	for(uint32_t i=0;i<OneOneClause;i++){
@@ -57,7 +80,7 @@ void setSampleProblem(uint32_t& variables, std::vector<clause3>& clause3s, std::
 		varA *= realSol[varA-1];
 		varB *= -realSol[varB-1];
 		//std::cout << "Clause " << varA << ", " << varB << std::endl;
-		float weight = w1 ? 1 : (variables+variableChoser(generator))*variableChoser(generator)*0.1;
+		double weight = w1 ? 1 : (variables+variableChoser(generator))*variableChoser(generator)*0.1;
 		clause2s.push_back({weight, varA, varB});
 	}
 	for(uint32_t i=0;i<bothFalseClause;i++){
@@ -66,11 +89,1350 @@ void setSampleProblem(uint32_t& variables, std::vector<clause3>& clause3s, std::
 		varA *= -realSol[varA-1];
 		varB *= -realSol[varB-1];
 		//std::cout << "Clause " << varA << ", " << varB << std::endl;
-		float weight = w1 ? 1 : (variables+variableChoser(generator))*variableChoser(generator)*0.1;
+		double weight = w1 ? 1 : (variables+variableChoser(generator))*variableChoser(generator)*0.1;
 		clause2s.push_back({weight, varA, varB});
 	}
 	
 	/*clause3s.push_back({1, 1, 2, 3});
 	clause3s.push_back({1.5, -1, -4, 3});
 	clause3s.push_back({1.6, -2, -3, 4});*/
+}
+
+//Regression checks. Each prints what it finds wrong and returns false if
+//anything was.
+
+//A random literal over variables 1..n
+static int randomLiteral(Rng& rng, uint32_t n){
+	int v = 1 + rng.below(n);
+	return rng.below(2) ? v : -v;
+}
+
+//from3SAT the way it used to be built: the gadget clauses appended to
+//(copies of) the inputs and handed to from2SAT. A negated literal ~x of
+//weight w counts as w minus the literal x of weight w.
+static Problem* from3SATThrough2SAT(uint32_t n, const std::vector<clause3>& clause3s, std::vector<clause2> clause2s, std::vector<double> literalWeights){
+	double shift = 0;
+	for(uint32_t c=0;c<clause3s.size();c++){
+		double w = std::get<0>(clause3s[c]);
+		int xi = std::get<1>(clause3s[c]), xj = std::get<2>(clause3s[c]), xk = std::get<3>(clause3s[c]);
+		int v = 1+n+c;
+		for(int x : {xi, xj, xk}){
+			literalWeights[abs(x)-1] += x > 0 ? w : -w;
+			if(x < 0) shift += w;
+		}
+		literalWeights.push_back(w);
+		clause2s.push_back({w, -xi, -xj});
+		clause2s.push_back({w, -xj, -xk});
+		clause2s.push_back({w, -xi, -xk});
+		clause2s.push_back({w, xi, -v});
+		clause2s.push_back({w, xj, -v});
+		clause2s.push_back({w, xk, -v});
+		shift -= 6*w;
+	}
+	Problem* res = Problem::from2SAT(n+clause3s.size(), clause2s, literalWeights);
+	res->constantTerm += shift;
+	return res;
+}
+
+//from3SAT gives the same coefficients as the reduction through from2SAT,
+//leaves its inputs alone, and its best score over the auxiliaries is the
+//satisfied weight of every assignment
+static bool checkFrom3SAT(){
+	Rng rng(27);
+	bool ok = true;
+	for(int trial=0;trial<200;trial++){
+		uint32_t n = 3 + rng.below(6), m = rng.below(6);
+		std::vector<clause3> clause3s;
+		std::vector<clause2> clause2s;
+		std::vector<double> literalWeights;
+		for(uint32_t i=0;i<n;i++) literalWeights.push_back(rng.below(3));
+		for(uint32_t c=0;c<m;c++){
+			int xi = randomLiteral(rng, n), xj, xk;
+			do xj = randomLiteral(rng, n); while(abs(xj) == abs(xi));
+			do xk = randomLiteral(rng, n); while(abs(xk) == abs(xi) || abs(xk) == abs(xj));
+			clause3s.push_back({1. + rng.below(3), xi, xj, xk});
+		}
+		for(uint32_t c=0;c<n;c++){
+			int x = randomLiteral(rng, n), y;
+			do y = randomLiteral(rng, n); while(abs(y) == abs(x));
+			clause2s.push_back({1. + rng.below(3), x, y});
+		}
+		std::vector<clause3> clause3sBefore = clause3s;
+		std::vector<clause2> clause2sBefore = clause2s;
+		std::vector<double> literalWeightsBefore = literalWeights;
+		
+		Problem* p = Problem::from3SAT(n, clause3s, clause2s, literalWeights);
+		Problem* q = from3SATThrough2SAT(n, clause3s, clause2s, literalWeights);
+		if(clause3s != clause3sBefore || clause2s != clause2sBefore || literalWeights != literalWeightsBefore){
+			printf("from3SAT: trial %d changed its inputs\n", trial);
+			ok = false;
+		}
+		if(MatrixXd(p->coeffs - q->coeffs).cwiseAbs().maxCoeff() > 1e-12 || fabs(p->constantTerm - q->constantTerm) > 1e-12){
+			printf("from3SAT: trial %d differs from the reduction through from2SAT\n", trial);
+			ok = false;
+		}
+		
+		VectorXd sol(p->nQP);
+		sol[0] = 1;
+		for(uint32_t bits=0;bits<(1u<<n);bits++){
+			auto truth = [&](int x){ return ((bits >> (abs(x)-1)) & 1) == (x > 0); };
+			double satisfied = 0;
+			for(uint32_t i=0;i<n;i++) if(truth(i+1)) satisfied += literalWeights[i];
+			for(auto& c : clause2s) if(truth(std::get<1>(c)) || truth(std::get<2>(c))) satisfied += std::get<0>(c);
+			for(auto& c : clause3s) if(truth(std::get<1>(c)) || truth(std::get<2>(c)) || truth(std::get<3>(c))) satisfied += std::get<0>(c);
+			
+			for(uint32_t i=0;i<n;i++) sol[1+i] = truth(i+1) ? 1 : -1;
+			double best = -INFINITY;
+			for(uint32_t aux=0;aux<(1u<<m);aux++){
+				for(uint32_t c=0;c<m;c++) sol[1+n+c] = (aux >> c) & 1 ? 1 : -1;
+				best = std::max(best, p->score(sol));
+			}
+			if(fabs(best - satisfied) > 1e-9){
+				printf("from3SAT: trial %d scores %g where %g is satisfied\n", trial, best, satisfied);
+				ok = false;
+				break;
+			}
+		}
+		delete &p->coeffs;
+		delete p;
+		delete &q->coeffs;
+		delete q;
+	}
+	return ok;
+}
+
+//Exposes the separators, and lets the LP solution be set directly
+class SeparationHarness : public LPSolver
+{
+ public:
+	SeparationHarness(Problem* p, const LPSolverConfig& config) : LPSolver(p, config) {}
+	
+	void setSolution(const std::vector<double>& x){
+		currSol = x;
+		cacheSolution();
+	}
+	
+	//Row r (1-indexed) of the LP at the current solution: activity minus
+	//right side
+	double rowSlackAt(int r){
+		double rightSide;
+		uint32_t len = lp->getRow(r, &rowIndices[0], &rowValues[0], rightSide);
+		double activity = 0;
+		for(uint32_t k=1;k<=len;k++) activity += rowValues[k]*currSol[rowIndices[k]-1];
+		return activity - rightSide;
+	}
+	
+	using LPSolver::separateOddCycles;
+	using LPSolver::separateHypermetric;
+	using LPSolver::findConstraint;
+	using LPSolver::addConstraint;
+	using LPSolver::deleteRows;
+	using LPSolver::lp;
+	using LPSolver::pairs;
+};
+
+//On random points, every odd-cycle cut added is violated by at least
+//minCutViolation, and one is found whenever a triangle of the support
+//graph is
+static bool checkOddCycles(){
+	Rng rng(31);
+	bool ok = true;
+	for(int trial=0;trial<100;trial++){
+		uint32_t n = 6 + rng.below(10);
+		Problem p(n);
+		for(uint32_t i=0;i<n;i++)
+			for(uint32_t j=i+1;j<n;j++)
+				if(rng.uniform() < 0.4) p.coeffs.coeffRef(i,j) = rng.below(2) ? 1 : -1;
+		
+		LPSolverConfig config;
+		config.verbose = false;
+		SeparationHarness solver(&p, config);
+		//Mostly near a +-1 assignment, so that only some cycles are violated
+		std::vector<int> v(n);
+		for(uint32_t i=0;i<n;i++) v[i] = rng.below(2) ? 1 : -1;
+		std::vector<double> x(n*(n-1)/2);
+		for(uint32_t i=1;i<n;i++)
+			for(uint32_t j=0;j<i;j++)
+				x[solver.pairs(i,j)-1] = std::max(-1., std::min(1., v[i]*v[j]*(1 - 0.8*rng.uniform())));
+		solver.setSolution(x);
+		
+		bool triangleViolated = false;
+		for(uint32_t i=0;i<n;i++)
+			for(uint32_t j=i+1;j<n;j++)
+				for(uint32_t k=j+1;k<n && p.coeffs.coeff(i,j) != 0;k++){
+					if(p.coeffs.coeff(i,k) == 0 || p.coeffs.coeff(j,k) == 0) continue;
+					double a = x[solver.pairs(i,j)-1], b = x[solver.pairs(i,k)-1], c = x[solver.pairs(j,k)-1];
+					double least = std::min(std::min(a+b+c, a-b-c), std::min(b-a-c, c-a-b));
+					if(least < -1 - config.minCutViolation) triangleViolated = true;
+				}
+		
+		uint32_t added = solver.separateOddCycles();
+		if(triangleViolated && added == 0){
+			printf("odd cycles: trial %d missed a violated triangle\n", trial);
+			ok = false;
+		}
+		for(uint32_t r=1;r<=solver.lp->numRows();r++){
+			double slack = solver.rowSlackAt(r);
+			if(slack > -config.minCutViolation + 1e-12){
+				printf("odd cycles: trial %d added row %u with slack %g\n", trial, r, slack);
+				ok = false;
+			}
+		}
+		delete &p.coeffs;
+	}
+	return ok;
+}
+
+//On random points, with the odd-cycle search run first as in a round:
+//every row the hypermetric search adds holds at every +-1 assignment
+//(checked by brute force) and is violated by at least minCutViolation, and
+//no row is in the LP twice, though violated triangles are found by both.
+//Each row added again, its entries reversed, is refused; with its first
+//coefficient negated it is taken unless that row is in the LP too, and
+//once it has been deleted it is taken again.
+static bool checkHypermetric(){
+	Rng rng(30);
+	bool ok = true;
+	uint32_t total = 0;
+	for(int trial=0;trial<100;trial++){
+		uint32_t n = 5 + rng.below(5);
+		Problem p(n);
+		for(uint32_t i=0;i<n;i++)
+			for(uint32_t j=i+1;j<n;j++)
+				p.coeffs.coeffRef(i,j) = rng.below(2) ? 1 : -1;
+		
+		LPSolverConfig config;
+		config.verbose = false;
+		SeparationHarness solver(&p, config);
+		//Half near a +-1 assignment, half anywhere in the box
+		std::vector<int> v(n);
+		for(uint32_t i=0;i<n;i++) v[i] = rng.below(2) ? 1 : -1;
+		std::vector<double> x(n*(n-1)/2);
+		for(uint32_t i=1;i<n;i++)
+			for(uint32_t j=0;j<i;j++)
+				x[solver.pairs(i,j)-1] = trial % 2 ? v[i]*v[j]*(1 - 1.2*rng.uniform()) : 2*rng.uniform() - 1;
+		solver.setSolution(x);
+		
+		uint32_t oddRows = solver.separateOddCycles();
+		uint32_t added = solver.separateHypermetric();
+		total += added;
+		if(solver.lp->numRows() != oddRows + added){
+			printf("hypermetric: trial %d has %u rows, but %u + %u were added\n", trial, solver.lp->numRows(), oddRows, added);
+			ok = false;
+		}
+		
+		std::set<std::vector<std::pair<int,double>>> rows;
+		std::vector<int> indices(x.size()+1);
+		std::vector<double> values(x.size()+1);
+		for(uint32_t r=1;r<=solver.lp->numRows();r++){
+			double rightSide;
+			uint32_t len = solver.lp->getRow(r, &indices[0], &values[0], rightSide);
+			std::vector<std::pair<int,double>> row(1, {0, rightSide});
+			for(uint32_t k=1;k<=len;k++) row.push_back({indices[k], values[k]});
+			std::sort(row.begin(), row.end());
+			if(!rows.insert(row).second){
+				printf("hypermetric: trial %d has row %u in the LP twice\n", trial, r);
+				ok = false;
+			}
+			
+			double slack = solver.rowSlackAt(r);
+			if(slack > -config.minCutViolation + 1e-12){
+				printf("hypermetric: trial %d added row %u with slack %g\n", trial, r, slack);
+				ok = false;
+			}
+			if(r <= oddRows) continue;
+			//x_ij = s_i s_j doesn't change when s does sign, so fix s_0 = 1
+			for(uint32_t bits=0;bits<(1u<<(n-1));bits++){
+				auto s = [&](uint32_t i){ return i == 0 || (bits >> (i-1)) & 1 ? 1 : -1; };
+				double activity = 0;
+				for(uint32_t k=1;k<=len;k++){
+					std::pair<uint32_t,uint32_t> ij = solver.pairs.pair(indices[k]);
+					activity += values[k]*s(ij.first)*s(ij.second);
+				}
+				if(activity < rightSide - 1e-9){
+					printf("hypermetric: trial %d added row %u, which cuts off assignment %u\n", trial, r, bits);
+					ok = false;
+					break;
+				}
+			}
+		}
+		
+		uint32_t found = solver.lp->numRows();
+		for(uint32_t r=1;r<=found;r++){
+			double rightSide;
+			uint32_t len = solver.lp->getRow(r, &indices[0], &values[0], rightSide);
+			std::reverse(indices.begin()+1, indices.begin()+len+1);
+			std::reverse(values.begin()+1, values.begin()+len+1);
+			bool again = solver.addConstraint(len, &indices[0], &values[0], rightSide);
+			values[1] = -values[1];
+			std::vector<std::pair<int,double>> row(1, {0, rightSide});
+			for(uint32_t k=1;k<=len;k++) row.push_back({indices[k], values[k]});
+			std::sort(row.begin(), row.end());
+			bool fresh = rows.insert(row).second;
+			if(again || solver.addConstraint(len, &indices[0], &values[0], rightSide) != fresh){
+				printf("hypermetric: trial %d took row %u twice, or %s it with a coefficient negated\n", trial, r, fresh ? "refused" : "took");
+				ok = false;
+			}
+		}
+		if(found > 0){
+			double rightSide;
+			uint32_t len = solver.lp->getRow(1, &indices[0], &values[0], rightSide);
+			std::vector<uint32_t> first(1, 0);
+			solver.deleteRows(first);
+			if(!solver.addConstraint(len, &indices[0], &values[0], rightSide)){
+				printf("hypermetric: trial %d refused row 1 once it was deleted\n", trial);
+				ok = false;
+			}
+		}
+		delete &p.coeffs;
+	}
+	if(total == 0){
+		printf("hypermetric: no cuts found in any trial\n");
+		ok = false;
+	}
+	return ok;
+}
+
+//The most violated hypermetric inequality sum_{i<j} b_i b_j x_ij >=
+//(1 - sum b_i^2)/2 on X, over every b in {-2..2}^N with an odd sum, by
+//depth-first search with the left side kept up to date. [0] is over the
+//shapes findConstraint searches (odd supports of at least 3 with unit
+//entries, and for even N the full support with one entry of 2), [1] over
+//all of them.
+struct BruteForceHypermetric {
+	const MatrixXd& X;
+	std::vector<int> b, best[2];
+	double violation[2];
+	
+	BruteForceHypermetric(const MatrixXd& x) : X(x), b(x.rows(), 0) {
+		violation[0] = violation[1] = -INFINITY;
+		search(0, 0);
+	}
+	
+	void search(uint32_t i, double lhs){
+		uint32_t n = b.size();
+		if(i == n){
+			int sum = 0, norm2 = 0, support = 0, twos = 0;
+			for(int v : b){
+				sum += v;
+				norm2 += v*v;
+				support += v != 0;
+				twos += abs(v) == 2;
+			}
+			if(sum % 2 == 0) return;
+			double violation = (1 - norm2)/2. - lhs;
+			bool shape = (twos == 0 && support >= 3) || (n % 2 == 0 && twos == 1 && support == (int)n);
+			for(int all=0;all<2;all++){
+				if((all || shape) && violation > this->violation[all]){
+					this->violation[all] = violation;
+					best[all] = b;
+				}
+			}
+			return;
+		}
+		double row = 0;
+		for(uint32_t j=0;j<i;j++) row += b[j]*X(i,j);
+		for(int v=-2;v<=2;v++){
+			b[i] = v;
+			search(i+1, lhs + v*row);
+		}
+		b[i] = 0;
+	}
+};
+
+//A random symmetric matrix with unit diagonal and a negative eigenvalue
+static MatrixXd randomNonPSD(Rng& rng, uint32_t n, double psdTolerance){
+	MatrixXd X(n, n);
+	do {
+		for(uint32_t i=0;i<n;i++){
+			X(i,i) = 1;
+			for(uint32_t j=0;j<i;j++) X(i,j) = X(j,i) = 2*rng.uniform() - 1;
+		}
+	} while(Eigen::SelfAdjointEigenSolver<MatrixXd>(X, Eigen::EigenvaluesOnly).eigenvalues()[0] >= -psdTolerance);
+	return X;
+}
+
+//LPSolver::findConstraint on random non-PSD cores of 3 to 10 rows, against
+//the brute-force search: it returns the most violated inequality of the
+//shapes it searches, as its right side and coefficients, whenever that is
+//violated by more than minCutViolation, and never one more violated than
+//the best over all of {-2..2}^N. Some cores of up to 7 rows are moved
+//towards the identity until their most violated inequality is just under
+//or just over minCutViolation; those under it, even of 5 rows or fewer,
+//give nothing. No non-PSD core of 5 rows or fewer misses an inequality,
+//while a PSD one (as rounding can pass on) is counted as a miss.
+static bool checkFindConstraint(){
+	Rng rng(28);
+	bool ok = true;
+	for(uint32_t n=3;n<=10;n++){
+		Problem p(n);
+		LPSolverConfig config;
+		config.verbose = false;
+		SeparationHarness solver(&p, config);
+		int trials = n <= 8 ? 30 : 12 - n;
+		for(int trial=0;trial<trials;trial++){
+			MatrixXd X = randomNonPSD(rng, n, config.psdTolerance);
+			if(n <= 7 && trial % 3 != 0 && BruteForceHypermetric(X).violation[0] > 2*config.minCutViolation){
+				//Every violation is linear in the scale of the off-diagonal,
+				//so the largest grows with it: bisect for the target
+				double target = (trial % 3 == 1 ? 0.5 : 2)*config.minCutViolation;
+				MatrixXd identity = MatrixXd::Identity(n, n), full = X;
+				double low = 0, high = 1;
+				for(int halving=0;halving<40;halving++){
+					double t = (low + high)/2;
+					if(BruteForceHypermetric(identity + t*(full - identity)).violation[0] < target) low = t;
+					else high = t;
+				}
+				X = identity + high*(full - identity);
+			}
+			BruteForceHypermetric brute(X);
+			std::vector<double> constraint;
+			bool found = solver.findConstraint(X, constraint);
+			if(found != (brute.violation[0] > config.minCutViolation)){
+				printf("find constraint: %u rows, trial %d %s, with %g the most violated\n", n, trial, found ? "found an inequality" : "found nothing", brute.violation[0]);
+				ok = false;
+			}
+			if(!found) continue;
+			
+			const std::vector<int>& b = brute.best[0];
+			int norm2 = 0;
+			for(int v : b) norm2 += v*v;
+			bool same = constraint.size() == 1 + n*(n-1)/2 && constraint[0] == (1 - norm2)/2.;
+			double lhs = 0;
+			for(uint32_t x=1, v=1;x<n && same;x++){
+				for(uint32_t y=0;y<x;y++, v++){
+					same = same && constraint[v] == b[x]*b[y];
+					lhs += constraint[v]*X(x,y);
+				}
+			}
+			if(!same){
+				printf("find constraint: %u rows, trial %d found another inequality than the most violated, %g\n", n, trial, brute.violation[0]);
+				ok = false;
+			}
+			if(constraint[0] - lhs > brute.violation[1] + 1e-12){
+				printf("find constraint: %u rows, trial %d claims a violation of %g, beyond the %g of any b\n", n, trial, constraint[0] - lhs, brute.violation[1]);
+				ok = false;
+			}
+		}
+		if(solver.metrics.totalCount[COUNT_CORE_MISSES] != 0){
+			printf("find constraint: %u rows, %u non-PSD cores had no violated inequality\n", n, (unsigned)solver.metrics.totalCount[COUNT_CORE_MISSES]);
+			ok = false;
+		}
+		if(n <= 5){
+			std::vector<double> constraint;
+			if(solver.findConstraint(MatrixXd::Identity(n, n), constraint) || solver.metrics.totalCount[COUNT_CORE_MISSES] != 1){
+				printf("find constraint: %u rows, the identity wasn't counted as a miss\n", n);
+				ok = false;
+			}
+		}
+		delete &p.coeffs;
+	}
+	return ok;
+}
+
+//The odd-cycle rows added, and their order, don't depend on the number of
+//threads. Points on a grid of 0.5 make many cycles tie on weight, and a
+//small oddCycleMaxCuts makes the ties decide which are kept.
+static bool checkOddCycleThreads(){
+	Rng rng(33);
+	bool ok = true;
+	for(int trial=0;trial<100;trial++){
+		uint32_t n = 40 + rng.below(60);
+		Problem p(n);
+		for(uint32_t i=0;i<n;i++)
+			for(uint32_t j=i+1;j<n;j++)
+				if(rng.uniform() < 0.5) p.coeffs.coeffRef(i,j) = rng.below(2) ? 1 : -1;
+		std::vector<double> x(n*(n-1)/2);
+		for(double& xe : x) xe = 0.5*((int)rng.below(5) - 2);
+		
+		//One run on 1 thread, then a few on 4, as thread timing varies
+		std::vector<std::vector<double>> rows[2];
+		for(int run=0;run<6;run++){
+			LPSolverConfig config;
+				config.verbose = false;
+			config.oddCycleMaxCuts = 5;
+			config.threads = run ? 4 : 1;
+			rows[run > 0].clear();
+			SeparationHarness solver(&p, config);
+			solver.setSolution(x);
+			solver.separateOddCycles();
+			std::vector<int> indices(x.size()+1);
+			std::vector<double> values(x.size()+1);
+			for(uint32_t r=1;r<=solver.lp->numRows();r++){
+				double rightSide;
+				uint32_t len = solver.lp->getRow(r, &indices[0], &values[0], rightSide);
+				std::vector<double> row(x.size()+1, 0);
+				for(uint32_t k=1;k<=len;k++) row[indices[k]] = values[k];
+				row[0] = rightSide;
+				rows[run > 0].push_back(row);
+			}
+			if(run > 0 && rows[0] != rows[1]){
+				printf("odd cycles: trial %d adds other rows on 4 threads than on 1\n", trial);
+				ok = false;
+				break;
+			}
+		}
+		delete &p.coeffs;
+	}
+	return ok;
+}
+
+//PairIndex and SparsePairIndex map pairs to columns and back, and
+//checked() rejects what isn't a pair
+static bool checkPairIndex(){
+	bool ok = true;
+	for(uint32_t n : {1u, 2u, 3u, 17u, 300u}){
+		PairIndex pairs(n);
+		uint32_t column = 0;
+		for(uint32_t x=1;x<n;x++){
+			for(uint32_t y=0;y<x;y++){
+				column++;
+				std::pair<uint32_t,uint32_t> back = pairs.pair(column);
+				if(pairs.index(x,y) != column || pairs(y,x) != column || pairs.checked(x,y) != column || back.first != x || back.second != y){
+					printf("pair index: n=%u, (%u,%u) is not column %u both ways\n", n, x, y, column);
+					ok = false;
+				}
+			}
+		}
+		if(pairs.size() != column){
+			printf("pair index: n=%u has size %u, not %u\n", n, pairs.size(), column);
+			ok = false;
+		}
+		bool threw = false;
+		try { pairs.checked(n, 0); } catch(std::runtime_error&){ threw = true; }
+		if(!threw){
+			printf("pair index: n=%u took (%u,0)\n", n, n);
+			ok = false;
+		}
+	}
+	
+	Rng rng(32);
+	SparsePairIndex sparse;
+	for(int i=0;i<1000;i++){
+		uint32_t x = rng.below(100), y;
+		do y = rng.below(100); while(y == x);
+		uint32_t had = sparse(x, y), column = sparse.add(x, y);
+		std::pair<uint32_t,uint32_t> back = sparse.pair(column);
+		if((had != 0 && had != column) || sparse(y, x) != column || back.first != std::max(x,y) || back.second != std::min(x,y)){
+			printf("sparse pair index: (%u,%u) is not column %u both ways\n", x, y, column);
+			ok = false;
+		}
+	}
+	return ok;
+}
+
+//Every assignment of p with x_0 = +1, in turn, as sol
+template<typename F>
+static void forEachAssignment(const Problem& p, F f){
+	VectorXd sol(p.nQP);
+	sol[0] = 1;
+	for(uint32_t bits=0;bits<(1u<<(p.nQP-1));bits++){
+		for(uint32_t i=1;i<p.nQP;i++) sol[i] = (bits >> (i-1)) & 1 ? 1 : -1;
+		f(sol);
+	}
+}
+
+//On small random problems, checked by brute force: the reduced problem
+//scores every assignment as the original scores its expansion, the optimum
+//is kept, roofBound is an upper bound, and with dominance off (so every
+//fixing is by roof duality) each fixed variable has its fixed value in
+//every optimum
+static bool checkPresolve(){
+	Rng rng(39);
+	bool ok = true;
+	for(int trial=0;trial<2000;trial++){
+		uint32_t n = 2 + rng.below(11);
+		double density = 0.2 + 0.6*rng.uniform();
+		Problem p(n);
+		for(uint32_t j=1;j<n;j++){
+			p.coeffs.coeffRef(0,j) = (int)rng.below(9) - 4;
+			for(uint32_t i=1;i<j;i++)
+				if(rng.uniform() < density) p.coeffs.coeffRef(i,j) = (int)rng.below(5) - 2;
+		}
+		
+		double best = -INFINITY;
+		forEachAssignment(p, [&](const VectorXd& sol){ best = std::max(best, p.score(sol)); });
+		
+		for(int dominance=1;dominance>=0;dominance--){
+			PresolveConfig config;
+			config.dominance = dominance;
+			Presolve presolve(p, config);
+			double reducedBest = -INFINITY;
+			forEachAssignment(*presolve.reduced, [&](const VectorXd& sol){
+				double score = presolve.reduced->score(sol);
+				reducedBest = std::max(reducedBest, score);
+				if(fabs(score - p.score(presolve.expand(sol))) > 1e-9){
+					printf("presolve: trial %d scores a reduced assignment %g, its expansion %g\n", trial, score, p.score(presolve.expand(sol)));
+					ok = false;
+				}
+			});
+			if(fabs(reducedBest - best) > 1e-9){
+				printf("presolve: trial %d lost the optimum, %g for %g\n", trial, reducedBest, best);
+				ok = false;
+			}
+			if(presolve.roofBound < best - 1e-9){
+				printf("presolve: trial %d bounds the optimum %g by %g\n", trial, best, presolve.roofBound);
+				ok = false;
+			}
+			if(dominance) continue;
+			forEachAssignment(p, [&](const VectorXd& sol){
+				if(p.score(sol) < best - 1e-9) return;
+				for(uint32_t j=1;j<n;j++){
+					if(presolve.fixedValue[j] != 0 && presolve.fixedValue[j] != sol[j]){
+						printf("presolve: trial %d fixed x_%u to %d, but an optimum has %g\n", trial, j, presolve.fixedValue[j], sol[j]);
+						ok = false;
+					}
+				}
+			});
+		}
+		delete &p.coeffs;
+	}
+	return ok;
+}
+
+//A random graph on n vertices as a dense adjacency matrix
+static std::vector<std::vector<bool>> randomAdjacency(Rng& rng, uint32_t n, double density){
+	std::vector<std::vector<bool>> adjacent(n, std::vector<bool>(n, false));
+	for(uint32_t u=0;u<n;u++)
+		for(uint32_t v=u+1;v<n;v++)
+			adjacent[u][v] = adjacent[v][u] = rng.uniform() < density;
+	return adjacent;
+}
+
+//Whether g has exactly the edges of 'adjacent': each adjacency list
+//sorted, without repeats or self loops, and every edge stored both ways
+static bool sameGraph(const Graph& g, const std::vector<std::vector<bool>>& adjacent, const char* what, int trial){
+	uint32_t n = adjacent.size();
+	size_t edges = 0;
+	for(uint32_t u=0;u<n;u++)
+		for(uint32_t v=u+1;v<n;v++)
+			edges += adjacent[u][v];
+	bool ok = g.n == n && g.offsets.size() == n+1 && g.numEdges() == edges && g.adj.size() == 2*edges;
+	for(uint32_t u=0;u<n && ok;u++){
+		for(size_t a=g.offsets[u];a<g.offsets[u+1];a++){
+			uint32_t v = g.adj[a];
+			if(v >= n || v == u || (a > g.offsets[u] && v <= g.adj[a-1]) || !adjacent[u][v]) ok = false;
+		}
+		for(uint32_t v=0;v<n;v++)
+			if(g.hasEdge(u, v) != adjacent[u][v]) ok = false;
+	}
+	if(!ok)
+		printf("graph: trial %d, %s doesn't have the expected edges\n", trial, what);
+	return ok;
+}
+
+//Graph::fromEdges keeps each edge once, both ways, whatever repeats,
+//reversals and self loops the list has; complement() has exactly the other
+//pairs; and fromMaxClique refuses complements denser than it is allowed
+static bool checkGraph(){
+	Rng rng(26);
+	bool ok = true;
+	for(int trial=0;trial<300;trial++){
+		uint32_t n = 1 + rng.below(30);
+		std::vector<std::vector<bool>> adjacent = randomAdjacency(rng, n, rng.uniform());
+		std::vector<std::pair<uint32_t,uint32_t>> edges;
+		for(uint32_t u=0;u<n;u++){
+			for(uint32_t v=u+1;v<n;v++){
+				if(!adjacent[u][v]) continue;
+				for(uint32_t copies=1+rng.below(3);copies>0;copies--)
+					edges.push_back(rng.below(2) ? std::make_pair(u, v) : std::make_pair(v, u));
+			}
+			if(rng.below(4) == 0) edges.push_back({u, u});
+		}
+		rng.shuffle(edges.begin(), edges.end());
+		
+		Graph g = Graph::fromEdges(n, edges);
+		ok = sameGraph(g, adjacent, "fromEdges", trial) && ok;
+		
+		for(uint32_t u=0;u<n;u++)
+			for(uint32_t v=0;v<n;v++)
+				if(u != v) adjacent[u][v] = !adjacent[u][v];
+		ok = sameGraph(g.complement(), adjacent, "complement", trial) && ok;
+		
+		double density = n > 1 ? g.complement().numEdges()/(0.5*n*(n-1.)) : 0;
+		for(double allowed : {0.1, 0.5}){
+			bool threw = false;
+			try {
+				Problem* p = Problem::fromMaxClique(g, allowed);
+				delete &p->coeffs;
+				delete p;
+			} catch(std::runtime_error&){ threw = true; }
+			if(threw != (density > allowed)){
+				printf("graph: trial %d, fromMaxClique %s a complement of density %g, allowing %g\n", trial, threw ? "refused" : "took", density, allowed);
+				ok = false;
+			}
+		}
+	}
+	return ok;
+}
+
+//The best score of fromIndSet is the independence number, and that of
+//fromMaxClique the clique number, on small random graphs by brute force.
+//On a random graph of a million vertices, fromIndSet holds a term per
+//vertex and one per edge, and scores a maximal independent set by its size.
+static bool checkIndSet(){
+	Rng rng(126);
+	bool ok = true;
+	for(int trial=0;trial<200;trial++){
+		uint32_t n = 1 + rng.below(11);
+		std::vector<std::vector<bool>> adjacent = randomAdjacency(rng, n, rng.uniform());
+		std::vector<std::pair<uint32_t,uint32_t>> edges;
+		for(uint32_t u=0;u<n;u++)
+			for(uint32_t v=u+1;v<n;v++)
+				if(adjacent[u][v]) edges.push_back({u, v});
+		Graph g = Graph::fromEdges(n, edges);
+		
+		int independence = 0, clique = 0;
+		for(uint32_t set=0;set<(1u<<n);set++){
+			bool independent = true, complete = true;
+			for(uint32_t u=0;u<n;u++)
+				for(uint32_t v=u+1;v<n;v++)
+					if((set >> u) & 1 && (set >> v) & 1){
+						if(adjacent[u][v]) independent = false;
+						else complete = false;
+					}
+			if(independent) independence = std::max(independence, __builtin_popcount(set));
+			if(complete) clique = std::max(clique, __builtin_popcount(set));
+		}
+		
+		Problem* problems[2] = {Problem::fromIndSet(g), Problem::fromMaxClique(g, 1)};
+		int expected[2] = {independence, clique};
+		for(int which=0;which<2;which++){
+			double best = -INFINITY;
+			forEachAssignment(*problems[which], [&](const VectorXd& sol){ best = std::max(best, problems[which]->score(sol)); });
+			if(fabs(best - expected[which]) > 1e-9){
+				printf("%s: trial %d scores %g, but the optimum is %d\n", which ? "fromMaxClique" : "fromIndSet", trial, best, expected[which]);
+				ok = false;
+			}
+			delete &problems[which]->coeffs;
+			delete problems[which];
+		}
+	}
+	
+	uint32_t n = 1000000;
+	std::vector<std::pair<uint32_t,uint32_t>> edges(3*n);
+	for(auto& e : edges) e = {rng.below(n), rng.below(n)};
+	Graph g = Graph::fromEdges(n, edges);
+	Problem* p = Problem::fromIndSet(g);
+	VectorXd sol = VectorXd::Constant(n+1, -1);
+	sol(0) = 1;
+	uint32_t size = 0;
+	for(uint32_t u=0;u<n;u++){
+		bool free = true;
+		for(size_t a=g.offsets[u];a<g.offsets[u+1] && free;a++)
+			free = sol(g.adj[a]+1) < 0;
+		if(free){
+			sol(u+1) = 1;
+			size++;
+		}
+	}
+	if((size_t)p->coeffs.nonZeros() != n + g.numEdges() || fabs(p->score(sol) - size) > 1e-6){
+		printf("fromIndSet: %u vertices and %zu edges give %ld terms, and an independent set of %u scores %g\n", n, (size_t)g.numEdges(), (long)p->coeffs.nonZeros(), size, p->score(sol));
+		ok = false;
+	}
+	delete &p->coeffs;
+	delete p;
+	return ok;
+}
+
+//DecomposedSolver on problems made of disconnected blocks, their variables
+//shuffled among each other: a singleton, a block best set all to -1 (or,
+//the same, with x_0 = -1 against the rest), and a few random blocks. Its
+//solution must score its lower bound; both bounds must be those of one
+//LPSolver on the whole problem, and the optimum by brute force; and
+//solving the blocks on parallel threads must change nothing.
+static bool checkDecomposed(){
+	Rng rng(40);
+	bool ok = true;
+	for(int trial=0;trial<30;trial++){
+		std::vector<uint32_t> sizes = {1, 2 + rng.below(3)};
+		for(uint32_t b=rng.below(3);b>0;b--) sizes.push_back(1 + rng.below(4));
+		uint32_t n = 1;
+		for(uint32_t size : sizes) n += size;
+		std::vector<uint32_t> order(n-1);
+		for(uint32_t i=0;i<n-1;i++) order[i] = i+1;
+		rng.shuffle(order.begin(), order.end());
+		
+		Problem p(n);
+		p.constantTerm = rng.below(5);
+		uint32_t next = 0;
+		for(uint32_t b=0;b<sizes.size();b++){
+			std::vector<uint32_t> block(order.begin()+next, order.begin()+next+sizes[b]);
+			next += sizes[b];
+			//Block 1 pulls every variable to -1, and ties them together so
+			//that it stays one block
+			for(uint32_t a=0;a<block.size();a++){
+				p.coeffs.coeffRef(0, block[a]) = b == 1 ? -3 : (int)rng.below(5) - 2;
+				if(a > 0){
+					uint32_t i = std::min(block[a-1], block[a]), j = std::max(block[a-1], block[a]);
+					p.coeffs.coeffRef(i, j) = b == 1 ? 1 : (rng.below(2) ? 1 : -1)*(1. + rng.below(2));
+				}
+				for(uint32_t c=0;c+1<a;c++)
+					if(b != 1 && rng.below(2))
+						p.coeffs.coeffRef(std::min(block[c], block[a]), std::max(block[c], block[a])) = (int)rng.below(5) - 2;
+			}
+		}
+		double optimum = -INFINITY;
+		forEachAssignment(p, [&](const VectorXd& sol){ optimum = std::max(optimum, p.score(sol)); });
+		
+		LPSolverConfig config;
+		config.verbose = false;
+		config.seed = trial;
+		config.threads = 4;
+		LPSolver whole(&p, config);
+		whole.solve();
+		
+		DecomposedSolver* solvers[2];
+		for(int parallel=0;parallel<2;parallel++){
+			config.parallelComponents = parallel;
+			solvers[parallel] = new DecomposedSolver(&p, config);
+			solvers[parallel]->solve();
+		}
+		DecomposedSolver& serial = *solvers[0];
+		if(serial.components.size() != sizes.size()){
+			printf("decomposed: trial %d split %u blocks into %u components\n", trial, (uint32_t)sizes.size(), (uint32_t)serial.components.size());
+			ok = false;
+		}
+		if(fabs(p.score(serial.bestSol) - serial.lowerBound) > 1e-9){
+			printf("decomposed: trial %d has lower bound %g, but its solution scores %g\n", trial, serial.lowerBound, p.score(serial.bestSol));
+			ok = false;
+		}
+		if(fabs(serial.lowerBound - whole.lowerBound) > 1e-6 || fabs(serial.upperBound - whole.upperBound) > 1e-6 || fabs(serial.lowerBound - optimum) > 1e-6){
+			printf("decomposed: trial %d has bounds [%g, %g], one solver [%g, %g], optimum %g\n", trial, serial.lowerBound, serial.upperBound, whole.lowerBound, whole.upperBound, optimum);
+			ok = false;
+		}
+		if(solvers[1]->lowerBound != serial.lowerBound || solvers[1]->upperBound != serial.upperBound || solvers[1]->bestSol != serial.bestSol){
+			printf("decomposed: trial %d differs on parallel threads\n", trial);
+			ok = false;
+		}
+		delete solvers[0];
+		delete solvers[1];
+		delete &p.coeffs;
+	}
+	return ok;
+}
+
+//An LP that solves to whatever slacks and duals it is told to report
+class ScriptedLP : public LPBackend
+{
+ public:
+	std::vector<std::vector<std::pair<int,double>>> entries;
+	std::vector<double> rightSides, slacks, duals;
+	
+	const char* name() const { return "scripted"; }
+	void addColumns(uint32_t, double, double){}
+	void setObjective(int, double){}
+	double objective(int) const { return 0; }
+	void addRow(uint32_t len, const int* indices, const double* values, double rightSide){
+		entries.emplace_back();
+		for(uint32_t k=1;k<=len;k++) entries.back().push_back({indices[k], values[k]});
+		rightSides.push_back(rightSide);
+		slacks.push_back(0);
+		duals.push_back(0);
+	}
+	void deleteRows(uint32_t count, const int* rows){
+		for(uint32_t k=count;k>0;k--){
+			entries.erase(entries.begin() + rows[k]-1);
+			rightSides.erase(rightSides.begin() + rows[k]-1);
+			slacks.erase(slacks.begin() + rows[k]-1);
+			duals.erase(duals.begin() + rows[k]-1);
+		}
+	}
+	uint32_t numRows() const { return rightSides.size(); }
+	uint32_t getRow(int row, int* indices, double* values, double& rightSide) const {
+		const std::vector<std::pair<int,double>>& e = entries[row-1];
+		for(uint32_t k=0;k<e.size();k++){
+			indices[k+1] = e[k].first;
+			values[k+1] = e[k].second;
+		}
+		rightSide = rightSides[row-1];
+		return e.size();
+	}
+	LPStatus solve(){ return LP_OPTIMAL; }
+	uint64_t iterations() const { return 0; }
+	double objectiveValue() const { return 0; }
+	double colPrimal(int) const { return 0; }
+	double rowSlack(int row) const { return slacks[row-1]; }
+	double rowDual(int row) const { return duals[row-1]; }
+	BasisStatus rowStatus(int) const { return BASIS_UNKNOWN; }
+	BasisStatus colStatus(int) const { return BASIS_UNKNOWN; }
+};
+
+//One round of a removal history. Rows are named by letters; 'add' are
+//added first (again, for letters removed before), as the separators add
+//them at the end of the round before. Then 'state' gives each row of the
+//LP in order, as the round's solve leaves it: b binding (dual -1), B
+//binding (dual -4), or slack by s (0.5), S (1.5) or T (2.5). 'removed' are
+//the rows the policy must pick, in order, and 'rediscovered' how many of
+//'add' count as found again.
+struct RemovalRound {
+	const char* add;
+	const char* state;
+	double improvement;
+	const char* removed;
+	uint32_t rediscovered;
+};
+
+struct RemovalCase {
+	const char* name;
+	RemovalRule rule;
+	double slackIncrement;     //REMOVE_ABOVE_THRESHOLD, from 0.99
+	uint32_t slackRounds, maxRows, graceRounds; //REMOVE_AGED
+	uint32_t rediscoveryRounds;
+	std::vector<RemovalRound> rounds;
+};
+
+//Runs rounds of an LPSolver's row bookkeeping and removal policy on a
+//ScriptedLP, as LPSolver::solve does after each solve
+class RemovalHarness : public LPSolver
+{
+ public:
+	ScriptedLP* scripted;
+	
+	RemovalHarness(Problem* p, const LPSolverConfig& config) : LPSolver(p, config) {
+		lp.reset(scripted = new ScriptedLP());
+	}
+	
+	//The rows removed this round, by letter
+	std::string round(const RemovalRound& r, uint32_t& rediscovered){
+		uint64_t found = metrics.totalCount[COUNT_CUTS_REDISCOVERED];
+		for(const char* c=r.add;*c;c++){
+			int indices[] = {0, 1};
+			double values[] = {0, 1};
+			addConstraint(1, indices, values, -(*c - 'a' + 1));
+		}
+		rediscovered = metrics.totalCount[COUNT_CUTS_REDISCOVERED] - found;
+		metrics.endRound(NULL, 0, 0, lp->numRows());
+		
+		if(strlen(r.state) != lp->numRows())
+			return "(state for " + std::to_string(lp->numRows()) + " rows)";
+		for(uint32_t i=0;i<lp->numRows();i++){
+			char c = r.state[i];
+			scripted->slacks[i] = c == 's' ? 0.5 : c == 'S' ? 1.5 : c == 'T' ? 2.5 : 0;
+			scripted->duals[i] = c == 'b' ? -1 : c == 'B' ? -4 : 0;
+		}
+		updateRowInfo();
+		RoundState state = {metrics.rounds, r.improvement};
+		rowsToRemove.clear();
+		removal->select(rowInfo, state, rowsToRemove);
+		std::string removed;
+		for(uint32_t row : rowsToRemove) removed += (char)('a' - 1 - scripted->rightSides[row]);
+		std::sort(removed.begin(), removed.end());
+		deleteRows(rowsToRemove);
+		return removed;
+	}
+};
+
+//ThresholdRemovalPolicy and AgingRemovalPolicy, with the age of rows
+//kept by LPSolver::updateRowInfo and the rediscovery count by
+//addConstraint, on scripted histories of row slacks and duals
+static bool checkRemoval(){
+	std::vector<RemovalCase> cases = {
+		{"threshold", REMOVE_ABOVE_THRESHOLD, 0, 0, 0, 0, 50, {
+			{"abc", "bsS", 1, "c", 0},
+			{"", "ST", 0, "ab", 0},
+		}},
+		{"threshold growing on stalls", REMOVE_ABOVE_THRESHOLD, 1, 0, 0, 0, 50, {
+			{"abcd", "bsST", 0, "d", 0},  //threshold 1.99
+			{"", "bsS", 0, "", 0},        //2.99
+			{"", "bsS", 1, "c", 0},       //back to 0.99
+		}},
+		{"aging", REMOVE_AGED, 0, 2, 0, 2, 50, {
+			{"ab", "sb", 1, "", 0},
+			{"", "sb", 1, "a", 0},
+			{"c", "ss", 1, "", 0},
+			{"", "bs", 1, "c", 0},        //b binding again: its age starts over
+			{"", "s", 1, "", 0},
+			{"", "s", 1, "b", 0},
+		}},
+		{"aging over the row cap", REMOVE_AGED, 0, 5, 3, 1, 50, {
+			{"abcd", "Bbbb", 1, "", 0},   //over the cap, but nothing slack
+			{"", "ssbb", 1, "b", 0},      //equally old: b has the smaller duals
+			{"", "sbb", 1, "", 0},
+			{"e", "sbbb", 1, "a", 0},     //e is slack after its first solve
+			{"fg", "bbbbb", 1, "", 0},    //binding rows stay, cap or not
+		}},
+		{"grace from the row cap", REMOVE_AGED, 0, 5, 3, 2, 50, {
+			{"abcd", "bbbb", 1, "", 0},
+			{"e", "sbbbs", 1, "a", 0},    //e is spared after its first solve
+			{"", "bbbs", 1, "e", 0},      //but not after its second
+			{"fgh", "bbbsss", 1, "", 0},  //slack, but all new: over the cap
+		}},
+		{"rediscovery window", REMOVE_ABOVE_THRESHOLD, 0, 0, 0, 0, 2, {
+			{"a", "S", 1, "a", 0},
+			{"a", "S", 1, "a", 1},        //found again right after its removal
+			{"", "", 1, "", 0},
+			{"a", "b", 1, "", 1},         //a round later, still in the window
+			{"b", "bS", 1, "b", 0},
+			{"", "b", 1, "", 0},
+			{"", "b", 1, "", 0},
+			{"b", "bb", 1, "", 0},        //two rounds later: forgotten
+		}},
+		{"no rediscovery count", REMOVE_ABOVE_THRESHOLD, 0, 0, 0, 0, 0, {
+			{"a", "S", 1, "a", 0},
+			{"a", "b", 1, "", 0},
+		}},
+	};
+	
+	bool ok = true;
+	for(const RemovalCase& test : cases){
+		Problem p(2);
+		LPSolverConfig config;
+		config.verbose = false;
+		config.removal = test.rule;
+		config.removalSlackIncrement = test.slackIncrement;
+		config.removalSlackRounds = test.slackRounds;
+		config.maxRows = test.maxRows;
+		config.removalGraceRounds = test.graceRounds;
+		config.rediscoveryRounds = test.rediscoveryRounds;
+		RemovalHarness solver(&p, config);
+		for(uint32_t r=0;r<test.rounds.size();r++){
+			uint32_t rediscovered;
+			std::string removed = solver.round(test.rounds[r], rediscovered);
+			if(removed != test.rounds[r].removed || rediscovered != test.rounds[r].rediscovered){
+				printf("removal: %s, round %u removed \"%s\" with %u rediscovered, not \"%s\" with %u\n", test.name, r, removed.c_str(), rediscovered, test.rounds[r].removed, test.rounds[r].rediscovered);
+				ok = false;
+				break;
+			}
+		}
+		delete &p.coeffs;
+	}
+	return ok;
+}
+
+//A random row over columns 1..n as LPSolver's cuts are: 2 to 6 entries in
+//+-1 and +-2, with a right side that x0 meets with slack 0 to 2
+struct RandomRow {
+	std::vector<int> indices; //from [1], as the LP takes them
+	std::vector<double> values;
+	double rightSide;
+};
+
+static RandomRow randomRow(Rng& rng, const std::vector<int>& x0){
+	uint32_t n = x0.size();
+	uint32_t len = std::min(n, 2 + rng.below(5));
+	RandomRow row = {std::vector<int>(1), std::vector<double>(1), 0};
+	double activity = 0;
+	while(row.indices.size() <= len){
+		int col = 1 + rng.below(n);
+		if(std::find(row.indices.begin()+1, row.indices.end(), col) != row.indices.end()) continue;
+		double value = (rng.below(2) ? 1 : -1) * (1. + rng.below(2));
+		row.indices.push_back(col);
+		row.values.push_back(value);
+		activity += value*x0[col-1];
+	}
+	row.rightSide = activity - rng.below(3);
+	return row;
+}
+
+//Whether the last solve of lp is optimal for max c.x over [-1,1]^n and
+//rows: primal feasible, its row duals of the right sign, and the Lagrangian
+//bound they give (as LPSolver::certifiedBound) equal to its objective
+static bool certifyLP(LPBackend* lp, const std::vector<double>& c, const std::vector<RandomRow>& rows, int trial){
+	const double TOL = 1e-6;
+	uint32_t n = c.size();
+	double objective = 0;
+	bool ok = true;
+	for(uint32_t j=0;j<n;j++){
+		double x = lp->colPrimal(j+1);
+		objective += c[j]*x;
+		if(fabs(x) > 1 + TOL){
+			printf("lp: trial %d has column %u at %g\n", trial, j+1, x);
+			ok = false;
+		}
+	}
+	if(fabs(objective - lp->objectiveValue()) > TOL*(1 + fabs(objective))){
+		printf("lp: trial %d reports objective %g for a point at %g\n", trial, lp->objectiveValue(), objective);
+		ok = false;
+	}
+	
+	std::vector<double> reduced(c);
+	double bound = 0;
+	for(uint32_t i=0;i<rows.size();i++){
+		const RandomRow& row = rows[i];
+		double activity = 0;
+		for(uint32_t k=1;k<row.indices.size();k++) activity += row.values[k]*lp->colPrimal(row.indices[k]);
+		if(activity - row.rightSide < -TOL || fabs(activity - row.rightSide - lp->rowSlack(i+1)) > TOL){
+			printf("lp: trial %d has row %u at slack %g, reported as %g\n", trial, i+1, activity - row.rightSide, lp->rowSlack(i+1));
+			ok = false;
+		}
+		double mu = -lp->rowDual(i+1);
+		if(mu < -TOL){
+			printf("lp: trial %d has row %u with dual %g\n", trial, i+1, -mu);
+			ok = false;
+		}
+		for(uint32_t k=1;k<row.indices.size();k++) reduced[row.indices[k]-1] += mu*row.values[k];
+		bound -= mu*row.rightSide;
+	}
+	for(uint32_t j=0;j<n;j++) bound += fabs(reduced[j]);
+	if(fabs(bound - objective) > TOL*(1 + fabs(objective))){
+		printf("lp: trial %d has objective %g, but its duals bound it by %g\n", trial, objective, bound);
+		ok = false;
+	}
+	return ok;
+}
+
+//Relative tolerance pdlp is run to in checkLP
+static const double PDLP_TOLERANCE = 1e-6;
+
+//Whether the last solve of pdlp, for the same LP as certifyLP takes, is
+//as near optimal as it claims: the rows violated by no more than its
+//stopping test allows (||max(0, b - A x)|| <= tol (1 + ||b||)), row duals
+//of the right sign, and both its objective and the bound its duals give
+//within a few times the accuracy of its rows of the exact optimum
+static bool certifyApproximateLP(LPBackend* lp, const std::vector<double>& c, const std::vector<RandomRow>& rows, double optimum, int trial, int step){
+	uint32_t n = c.size();
+	bool ok = true;
+	double objective = 0;
+	for(uint32_t j=0;j<n;j++){
+		double x = lp->colPrimal(j+1);
+		objective += c[j]*x;
+		if(fabs(x) > 1){
+			printf("lp: pdlp trial %d step %d has column %u at %g\n", trial, step, j+1, x);
+			ok = false;
+		}
+	}
+	if(fabs(objective - lp->objectiveValue()) > 1e-9*(1 + fabs(objective))){
+		printf("lp: pdlp trial %d step %d reports objective %g for a point at %g\n", trial, step, lp->objectiveValue(), objective);
+		ok = false;
+	}
+	
+	std::vector<double> reduced(c);
+	double violation2 = 0, rightSide2 = 0, accuracy = 0, bound = 0;
+	for(uint32_t i=0;i<rows.size();i++){
+		const RandomRow& row = rows[i];
+		double activity = 0;
+		for(uint32_t k=1;k<row.indices.size();k++) activity += row.values[k]*lp->colPrimal(row.indices[k]);
+		double slack = activity - row.rightSide;
+		if(fabs(slack - lp->rowSlack(i+1)) > 1e-9*(1 + fabs(slack))){
+			printf("lp: pdlp trial %d step %d has row %u at slack %g, reported as %g\n", trial, step, i+1, slack, lp->rowSlack(i+1));
+			ok = false;
+		}
+		violation2 += std::min(slack, 0.)*std::min(slack, 0.);
+		rightSide2 += row.rightSide*row.rightSide;
+		accuracy = std::max(accuracy, lp->slackAccuracy(i+1));
+		
+		double mu = -lp->rowDual(i+1);
+		if(mu < 0){
+			printf("lp: pdlp trial %d step %d has row %u with dual %g\n", trial, step, i+1, -mu);
+			ok = false;
+		}
+		for(uint32_t k=1;k<row.indices.size();k++) reduced[row.indices[k]-1] += mu*row.values[k];
+		bound -= mu*row.rightSide;
+	}
+	for(uint32_t j=0;j<n;j++) bound += fabs(reduced[j]);
+	
+	if(sqrt(violation2) > PDLP_TOLERANCE*(1 + sqrt(rightSide2))){
+		printf("lp: pdlp trial %d step %d leaves the rows violated by %g\n", trial, step, sqrt(violation2));
+		ok = false;
+	}
+	double tolerance = 10*accuracy*(1 + fabs(optimum));
+	if(fabs(objective - optimum) > tolerance || bound < optimum - 1e-9*(1 + fabs(optimum)) || bound > optimum + tolerance){
+		printf("lp: pdlp trial %d step %d has objective %.9g and bound %.9g, %s %.9g\n", trial, step, objective, bound, "glpk-simplex", optimum);
+		ok = false;
+	}
+	return ok;
+}
+
+//glpk-simplex on random cut LPs that change between warm-started solves as
+//in the cut loop: batches of rows added, rows deleted and an objective
+//coefficient moved. Every solve must be certified optimal (certifyLP).
+//pdlp takes the same changes, warm-started, and must solve each LP to
+//its tolerance of that optimum (certifyApproximateLP).
+static bool checkLP(){
+	Rng rng(47);
+	bool ok = true;
+	for(int trial=0;trial<300 && ok;trial++){
+		uint32_t n = 4 + rng.below(40);
+		std::unique_ptr<LPBackend> lp(createLPBackend(LP_GLPK_SIMPLEX));
+		std::unique_ptr<LPBackend> approx(createLPBackend(LP_PDLP));
+		approx->setLimits(0, PDLP_TOLERANCE);
+		lp->addColumns(n, -1, 1);
+		approx->addColumns(n, -1, 1);
+		//Small integer costs, so the optimal face is often more than a vertex
+		std::vector<double> c(n);
+		for(uint32_t j=0;j<n;j++){
+			c[j] = (int)rng.below(5) - 2;
+			lp->setObjective(j+1, c[j]);
+			approx->setObjective(j+1, c[j]);
+		}
+		std::vector<int> x0(n);
+		for(uint32_t j=0;j<n;j++) x0[j] = rng.below(2) ? 1 : -1;
+		
+		std::vector<RandomRow> rows;
+		for(int step=0;step<15 && ok;step++){
+			if(rows.empty() || rng.below(3)){
+				for(uint32_t k=1+rng.below(8);k>0;k--){
+					rows.push_back(randomRow(rng, x0));
+					const RandomRow& row = rows.back();
+					lp->addRow(row.indices.size()-1, &row.indices[0], &row.values[0], row.rightSide);
+					approx->addRow(row.indices.size()-1, &row.indices[0], &row.values[0], row.rightSide);
+				}
+			} else {
+				std::vector<int> doomed(1);
+				std::vector<RandomRow> kept;
+				//pdlp keeps the slack and dual of the rows left, to warm start from
+				std::vector<std::pair<double,double>> keptState;
+				for(uint32_t i=0;i<rows.size();i++){
+					if(rng.below(3) == 0) doomed.push_back(i+1);
+					else {
+						kept.push_back(rows[i]);
+						keptState.push_back({approx->rowSlack(i+1), approx->rowDual(i+1)});
+					}
+				}
+				lp->deleteRows(doomed.size()-1, &doomed[0]);
+				approx->deleteRows(doomed.size()-1, &doomed[0]);
+				rows.swap(kept);
+				for(uint32_t i=0;i<rows.size();i++){
+					if(approx->rowSlack(i+1) != keptState[i].first || approx->rowDual(i+1) != keptState[i].second){
+						printf("lp: pdlp trial %d step %d lost the state of row %u in deleting rows\n", trial, step, i+1);
+						ok = false;
+					}
+				}
+			}
+			if(rng.below(4) == 0){
+				uint32_t j = rng.below(n);
+				c[j] = (int)rng.below(5) - 2;
+				lp->setObjective(j+1, c[j]);
+				approx->setObjective(j+1, c[j]);
+			}
+			
+			LPStatus status = lp->solve();
+			if(status != LP_OPTIMAL){
+				printf("lp: trial %d step %d returned status %d\n", trial, step, status);
+				ok = false;
+				break;
+			}
+			ok = certifyLP(lp.get(), c, rows, trial) && ok;
+			
+			//pdlp, warm-started through the same changes
+			status = approx->solve();
+			if(status != LP_OPTIMAL){
+				printf("lp: pdlp trial %d step %d returned status %d\n", trial, step, status);
+				ok = false;
+				break;
+			}
+			ok = certifyApproximateLP(approx.get(), c, rows, lp->objectiveValue(), trial, step) && ok;
+		}
+	}
+	return ok;
+}
+
+//Exposes the LP of an LPSolver, its rows and the bound from its duals
+class BoundHarness : public LPSolver
+{
+ public:
+	BoundHarness(Problem* p, const LPSolverConfig& config) : LPSolver(p, config) {}
+	
+	using LPSolver::lp;
+	using LPSolver::addConstraint;
+	using LPSolver::deleteRows;
+	using LPSolver::certifiedBound;
+};
+
+//The optimum of lp's LP, solved afresh by glpk-simplex
+static double referenceOptimum(const LPBackend& lp, uint32_t n){
+	std::unique_ptr<LPBackend> reference(createLPBackend(LP_GLPK_SIMPLEX));
+	reference->addColumns(n, -1, 1);
+	for(uint32_t j=1;j<=n;j++) reference->setObjective(j, lp.objective(j));
+	std::vector<int> indices(n+1);
+	std::vector<double> values(n+1);
+	for(uint32_t r=1;r<=lp.numRows();r++){
+		double rightSide;
+		uint32_t len = lp.getRow(r, &indices[0], &values[0], rightSide);
+		reference->addRow(len, &indices[0], &values[0], rightSide);
+	}
+	reference->solve();
+	return reference->objectiveValue();
+}
+
+//LPSolver::certifiedBound on random cut LPs that change between solves as
+//in the cut loop. Solves stopped after a few iterations (pdlp and
+//glpk-simplex) must still give a bound no lower than the exact optimum; a
+//solve to optimality by glpk-simplex must give the optimum itself, up to
+//rounding, and pdlp's converged solves must come within its tolerance of
+//it.
+static bool checkCertifiedBound(){
+	Rng rng(49);
+	bool ok = true;
+	std::vector<LPEngine> engines = {LP_PDLP, LP_GLPK_SIMPLEX};
+	for(int trial=0;trial<150 && ok;trial++){
+		uint32_t nQP = 4 + rng.below(7);
+		Problem p(nQP);
+		for(uint32_t i=0;i<nQP;i++)
+			for(uint32_t j=i+1;j<nQP;j++)
+				p.coeffs.coeffRef(i,j) = (int)rng.below(5) - 2;
+		p.constantTerm = rng.below(10);
+		
+		LPSolverConfig config;
+		config.lpEngine = engines[trial % engines.size()];
+		config.verbose = false;
+		BoundHarness solver(&p, config);
+		LPBackend& lp = *solver.lp;
+		uint32_t n = nQP*(nQP-1)/2;
+		std::vector<int> x0(n);
+		for(uint32_t j=0;j<n;j++) x0[j] = rng.below(2) ? 1 : -1;
+		
+		for(int step=0;step<10 && ok;step++){
+			if(lp.numRows() == 0 || rng.below(3)){
+				for(uint32_t k=1+rng.below(8);k>0;k--){
+					RandomRow row = randomRow(rng, x0);
+					solver.addConstraint(row.indices.size()-1, &row.indices[0], &row.values[0], row.rightSide);
+				}
+			} else {
+				std::vector<uint32_t> doomed;
+				for(uint32_t r=0;r<lp.numRows();r++)
+					if(rng.below(3) == 0) doomed.push_back(r);
+				solver.deleteRows(doomed);
+			}
+			
+			//Every other solve is cut short, where the engine can be
+			bool early = step % 2 == 0 && lp.setLimits(1 + rng.below(10), 0.1);
+			if(!early) lp.setLimits(0, 0);
+			LPStatus status = lp.solve();
+			double bound = solver.certifiedBound();
+			double optimum = p.constantTerm + referenceOptimum(lp, n);
+			if(status == LP_FAILED){
+				printf("certified bound: trial %d step %d failed under %s\n", trial, step, lp.name());
+				ok = false;
+			} else if(bound < optimum - 1e-9*(1 + fabs(optimum))){
+				printf("certified bound: trial %d step %d bounds the optimum %.9g by %.9g under %s%s\n", trial, step, optimum, bound, lp.name(), early ? ", stopped early" : "");
+				ok = false;
+			} else if(!early && status == LP_OPTIMAL){
+				//pdlp solves to a relative gap of 1e-6 in its scaled problem
+				double tolerance = config.lpEngine == LP_PDLP ? 1e-4 : 1e-9;
+				if(bound > optimum + tolerance*(1 + fabs(optimum))){
+					printf("certified bound: trial %d step %d bounds the optimum %.9g by %.9g at optimality under %s\n", trial, step, optimum, bound, lp.name());
+					ok = false;
+				}
+			}
+		}
+		delete &p.coeffs;
+	}
+	return ok;
+}
+
+bool runChecks(){
+	struct { const char* name; bool (*run)(); } checks[] = {
+		{"certified bound", checkCertifiedBound},
+		{"decomposed", checkDecomposed},
+		{"find constraint", checkFindConstraint},
+		{"from3SAT", checkFrom3SAT},
+		{"graph", checkGraph},
+		{"hypermetric", checkHypermetric},
+		{"independent set", checkIndSet},
+		{"lp", checkLP},
+		{"odd cycles", checkOddCycles},
+		{"odd cycle threads", checkOddCycleThreads},
+		{"pair index", checkPairIndex},
+		{"presolve", checkPresolve},
+		{"removal", checkRemoval},
+	};
+	bool ok = true;
+	for(auto& check : checks){
+		bool passed = check.run();
+		printf("%-18s %s\n", check.name, passed ? "ok" : "FAILED");
+		ok = ok && passed;
+	}
+	return ok;
 }
\ No newline at end of file